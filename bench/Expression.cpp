@@ -0,0 +1,35 @@
+// Code generation check for the expression templates, see check_expression.sh.
+// Each pair computes the same thing through the expression layer and by hand; the
+// expression version must compile to at least as many packed (vector) instructions.
+
+#include "../Geometry"
+
+using namespace Euclid;
+
+extern "C" {
+
+Point expression_fma ( const Point & a, const Vector & s, const Vector & b, double l ) { return a + s*(b*l); }
+Point hand_fma ( const Point & a, const Vector & s, const Vector & b, double l )
+{
+	return Point( a.x()+s.x()*(b.x()*l), a.y()+s.y()*(b.y()*l), a.z()+s.z()*(b.z()*l) );
+}
+
+Vector expression_sum ( const Vector & a, const Vector & b, const Vector & c ) { return a + b - c; }
+Vector hand_sum ( const Vector & a, const Vector & b, const Vector & c )
+{
+	return Vector( a.x()+b.x()-c.x(), a.y()+b.y()-c.y(), a.z()+b.z()-c.z() );
+}
+
+Point expression_min ( const Point & a, const Point & b, const Point & c ) { return emin( a, emin(b,c) ); }
+Point hand_min ( const Point & a, const Point & b, const Point & c )
+{
+	return Point( std::min(a.x(),std::min(b.x(),c.x())), std::min(a.y(),std::min(b.y(),c.y())), std::min(a.z(),std::min(b.z(),c.z())) );
+}
+
+Point expression_max ( const Point & a, const Point & b, const Point & c ) { return emax( a, emax(b,c) ); }
+Point hand_max ( const Point & a, const Point & b, const Point & c )
+{
+	return Point( std::max(a.x(),std::max(b.x(),c.x())), std::max(a.y(),std::max(b.y(),c.y())), std::max(a.z(),std::max(b.z(),c.z())) );
+}
+
+}
@@ -0,0 +1,119 @@
+// Times Grid against Hierarchy for closest triangle and ray queries.
+// Two meshes: a 500x500 height field (500k triangles, the case Grid is meant for)
+// and 100k small triangles scattered in a 20-unit cube.
+// Before timing, both backends answer the same queries and the mismatches are counted.
+// Build and run: c++ -std=c++17 -O3 -pthread bench/Grid.cpp -o grid && ./grid
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../Geometry"
+
+using namespace Euclid;
+using Clock = std::chrono::steady_clock;
+
+// Two triangles per unit cell over a gently rolling height field
+std::vector<Triangle> terrain ( int n )
+{
+	auto h = [] ( double x, double y ) { return 3.*sin(0.1*x)*cos(0.13*y); };
+	std::vector<Triangle> T;
+	T.reserve( 2*n*n );
+	for ( int i=0; i<n; ++i ) for ( int j=0; j<n; ++j )
+	{
+		Point a(i,j,h(i,j)), b(i+1,j,h(i+1,j)), c(i,j+1,h(i,j+1)), d(i+1,j+1,h(i+1,j+1));
+		T.emplace_back(a,b,c);
+		T.emplace_back(b,d,c);
+	}
+	return T;
+}
+
+// n triangles with sides up to one unit, centred uniformly in [-10,10]^3
+std::vector<Triangle> cloud ( size_t n )
+{
+	std::mt19937 g(1);
+	std::uniform_real_distribution<double> u(-10.,10.), s(-.5,.5);
+	std::vector<Triangle> T;
+	T.reserve(n);
+	for ( size_t i=0; i<n; ++i )
+	{
+		Point c( u(g),u(g),u(g) );
+		T.emplace_back( c+Point(s(g),s(g),s(g)), c+Point(s(g),s(g),s(g)), c+Point(s(g),s(g),s(g)) );
+	}
+	return T;
+}
+
+// Query points uniform in the box lo-hi, directions uniform in a cube
+struct Queries
+{
+	std::vector<Point> points;
+	std::vector<Vector> directions;
+	Queries ( size_t n, const Point & lo, const Point & hi, unsigned seed )
+	{
+		std::mt19937 g(seed);
+		std::uniform_real_distribution<double> u(0.,1.);
+		for ( size_t i=0; i<n; ++i )
+		{
+			points.emplace_back( lo.x()+u(g)*(hi.x()-lo.x()), lo.y()+u(g)*(hi.y()-lo.y()), lo.z()+u(g)*(hi.z()-lo.z()) );
+			directions.emplace_back( u(g)-.5, u(g)-.5, u(g)-.5 );
+		}
+	}
+};
+
+// Both backends must find a triangle at the same distance and the same ray hit
+void compare ( const Hierarchy & H, const Grid & G, const std::vector<Triangle> & T, const Queries & Q )
+{
+	size_t closest = 0, rays = 0;
+	for ( size_t i=0; i<Q.points.size(); ++i )
+	{
+		const Point & p = Q.points[i];
+		size_t a = H.closest_triangle(p), b = G.closest_triangle(p);
+		if ( a != b && std::abs( Vector(p,T[a].closest_point(p)).norm() - Vector(p,T[b].closest_point(p)).norm() ) > 1e-12 ) ++closest;
+		double s = 0., t = 0.;
+		bool hs = H.intersect(p,Q.directions[i],s), ht = G.intersect(p,Q.directions[i],t);
+		if ( hs != ht || ( hs && std::abs(s-t) > 1e-9 ) ) ++rays;
+	}
+	printf("  mismatches: closest %zu, rays %zu of %zu\n", closest, rays, Q.points.size());
+}
+
+// Average time per closest triangle and per ray query, in microseconds
+template<class Backend>
+void measure ( const char * name, const Backend & B, const Queries & Q )
+{
+	const size_t n = Q.points.size();
+	size_t sum = 0, hits = 0;
+	auto t0 = Clock::now();
+	for ( const Point & p : Q.points ) sum += B.closest_triangle(p);
+	auto t1 = Clock::now();
+	for ( size_t i=0; i<n; ++i ) { double t = 0.; hits += B.intersect(Q.points[i],Q.directions[i],t); }
+	auto t2 = Clock::now();
+	printf("  %-9s closest %7.3f us  ray %7.3f us  (checksum %zu, hits %zu)\n", name,
+		std::chrono::duration<double,std::micro>(t1-t0).count()/n,
+		std::chrono::duration<double,std::micro>(t2-t1).count()/n, sum, hits);
+}
+
+void run ( const char * name, const std::vector<Triangle> & T, const Point & lo, const Point & hi )
+{
+	auto t0 = Clock::now();
+	Hierarchy H(T);
+	auto t1 = Clock::now();
+	Grid G(T);
+	auto t2 = Clock::now();
+	printf("%s: %zu triangles, build Hierarchy %.1f ms, Grid %.1f ms (%zu cells, %zu references)\n", name, T.size(),
+		std::chrono::duration<double,std::milli>(t1-t0).count(),
+		std::chrono::duration<double,std::milli>(t2-t1).count(), G.cells(), G.references());
+	compare( H, G, T, Queries(3000,lo,hi,9) );
+	Queries Q(200000,lo,hi,3);
+	measure( "Hierarchy", H, Q );
+	measure( "Grid", G, Q );
+}
+
+int main ()
+{
+	// Queries within 4 units of the surface, rays in all directions
+	run( "terrain", terrain(500), Point(0,0,-4), Point(500,500,4) );
+	// Queries throughout the cloud
+	run( "cloud", cloud(100000), Point(-10,-10,-10), Point(10,10,10) );
+	return 0;
+}
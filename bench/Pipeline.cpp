@@ -0,0 +1,104 @@
+// Times Pipeline<Hierarchy,N> for a sweep of lane counts N against one query at a time
+// through Hierarchy::closest_triangle and Hierarchy::intersect, on a single thread.
+// The mesh is N small triangles scattered in a 20-unit cube, large enough by default
+// (2M triangles) that the tree does not fit in cache, which is where the lanes pay off.
+// Every result is compared with the one-at-a-time answer and mismatches are counted.
+// Build and run: c++ -std=c++17 -O3 -pthread bench/Pipeline.cpp -o pipeline && ./pipeline [triangles] [queries]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../Geometry"
+
+using namespace Euclid;
+using Clock = std::chrono::steady_clock;
+
+// n triangles with sides up to one unit, centred uniformly in [-10,10]^3
+std::vector<Triangle> cloud ( size_t n )
+{
+	std::mt19937 g(1);
+	std::uniform_real_distribution<double> u(-10.,10.), s(-.5,.5);
+	std::vector<Triangle> T;
+	T.reserve(n);
+	for ( size_t i=0; i<n; ++i )
+	{
+		Point c( u(g),u(g),u(g) );
+		T.emplace_back( c+Point(s(g),s(g),s(g)), c+Point(s(g),s(g),s(g)), c+Point(s(g),s(g),s(g)) );
+	}
+	return T;
+}
+
+double nanoseconds ( Clock::time_point a, Clock::time_point b, size_t n ) { return std::chrono::duration<double,std::nano>(b-a).count()/n; }
+
+// Queries and the answers of the hierarchy's own one-at-a-time queries
+struct Reference
+{
+	std::vector<Point> points;
+	std::vector<Vector> directions;
+	std::vector<size_t> closest;
+	std::vector<double> t;
+	std::vector<char> hit;
+	double closest_ns, ray_ns;
+
+	Reference ( const Hierarchy & H, size_t n )
+	: closest(n), t(n,0.), hit(n)
+	{
+		std::mt19937 g(5);
+		std::uniform_real_distribution<double> u(-10.,10.);
+		for ( size_t i=0; i<n; ++i ) { points.emplace_back(u(g),u(g),u(g)); directions.emplace_back(u(g),u(g),u(g)); }
+		auto a = Clock::now();
+		for ( size_t i=0; i<n; ++i ) closest[i] = H.closest_triangle(points[i]);
+		auto b = Clock::now();
+		for ( size_t i=0; i<n; ++i ) hit[i] = H.intersect(points[i],directions[i],t[i]);
+		auto c = Clock::now();
+		closest_ns = nanoseconds(a,b,n);
+		ray_ns = nanoseconds(b,c,n);
+	}
+};
+
+template<size_t N>
+void lanes ( const Hierarchy & H, const Reference & R )
+{
+	const size_t n = R.points.size();
+	Pipeline<Hierarchy,N> P(H);
+	std::vector<size_t> closest(n);
+	std::vector<double> t(n,0.);
+	std::unique_ptr<bool[]> hit( new bool[n] );
+	auto a = Clock::now();
+	P.closest_triangle( R.points.data(), n, closest.data() );
+	auto b = Clock::now();
+	P.intersect( R.points.data(), R.directions.data(), n, t.data(), hit.get() );
+	auto c = Clock::now();
+
+	size_t bad = 0;
+	for ( size_t i=0; i<n; ++i )
+	{
+		if ( closest[i] != R.closest[i] ) ++bad;
+		if ( hit[i] != bool(R.hit[i]) || ( hit[i] && t[i] != R.t[i] ) ) ++bad;
+	}
+	const double cn = nanoseconds(a,b,n), rn = nanoseconds(b,c,n);
+	printf("  %2zu lanes  closest %6.0f ns (x%.2f)  ray %6.0f ns (x%.2f)  mismatches %zu\n", N, cn, R.closest_ns/cn, rn, R.ray_ns/rn, bad);
+}
+
+int main ( int argc, char ** argv )
+{
+	const size_t triangles = argc > 1 ? std::strtoul(argv[1],nullptr,10) : 2000000;
+	const size_t queries   = argc > 2 ? std::strtoul(argv[2],nullptr,10) : 4000;
+
+	const std::vector<Triangle> T = cloud(triangles);
+	const Hierarchy H(T);
+	const Reference R(H,queries);
+	printf("%zu triangles, %zu queries\n", triangles, queries);
+	printf("  Hierarchy closest %6.0f ns  ray %6.0f ns\n", R.closest_ns, R.ray_ns);
+	lanes<1>(H,R);
+	lanes<2>(H,R);
+	lanes<4>(H,R);
+	lanes<8>(H,R);
+	lanes<16>(H,R);
+	lanes<32>(H,R);
+	return 0;
+}
@@ -0,0 +1,25 @@
+#!/bin/sh
+# Compiles Expression.cpp to assembly at several optimisation levels and fails if an
+# expression_* function has fewer packed double instructions than its hand_* twin.
+# Usage: bench/check_expression.sh [compiler], default c++
+
+CXX=${1:-c++}
+DIR=$(dirname "$0")
+ASM=$(mktemp)
+trap 'rm -f "$ASM"' EXIT
+status=0
+
+# Packed double instructions in the body of function $1
+count () { awk -v f="$1" '$0 ~ "^_?"f":" { on=1 } on && /\.cfi_endproc|^\.Lfunc_end/ { on=0 } on && $1 ~ /pd$/ { n++ } END { print n+0 }' "$ASM"; }
+
+for flags in "-O2" "-O3" "-O3 -march=native"; do
+	$CXX -std=c++17 $flags -S "$DIR/Expression.cpp" -o "$ASM" || exit 1
+	for f in fma sum min max; do
+		e=$(count expression_$f)
+		h=$(count hand_$f)
+		echo "$flags $f: expression $e, hand written $h packed instructions"
+		[ "$e" -ge "$h" ] || status=1
+	done
+done
+[ $status -eq 0 ] || echo "FAIL: expression templates compile to worse code than hand written"
+exit $status
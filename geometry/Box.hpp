@@ -1,6 +1,7 @@
 #ifndef EUCLID_GEOMETRY_BOX
 #define EUCLID_GEOMETRY_BOX
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <cfloat>
@@ -17,37 +18,71 @@ class Box {
 	Point _max;
 	public :
 	constexpr static double min_side_length { 5.0e-4 };
-	Box() {}
-	Box( const Point & a, const Point & b ) : _min(a),_max(b) {}
-	const Point & 	min() const { return _min; }
-	const Point & 	max() const { return _max; }
-	bool 				intersect	( const Ray & ) const;
-	bool 				intersect	( const Point&, const Vector& ) const;
-	Interval<Distance> 	distance	( const Point & ) const;
-	void			 	minmax_sq_dist	( const Point & ,double&,double&) const;
-	static Box 			box         ( const Triangle & );
-	static Box 			box_and_split( const std::vector<Triangle>&, std::vector<Triangle>&, std::vector<Triangle>&) ;				 
+	constexpr Box() {}
+	constexpr Box( const Point & a, const Point & b ) : _min(a),_max(b) {}
+	constexpr const Point & 	min() const { return _min; }
+	constexpr const Point & 	max() const { return _max; }
+	constexpr double 			surface_area() const;
+	constexpr bool 			intersect	( const Ray & ) const;
+	constexpr bool 			intersect	( const Point&, const Vector& ) const;
+	constexpr bool 			entry		( const Point&, const Vector&, double & ) const;
+	Interval<Distance> 		distance	( const Point & ) const;
+	constexpr void			minmax_sq_dist	( const Point & ,double&,double&) const;
+	constexpr static Box 	box         ( const Triangle & );
+	static Box 			box_and_split( const std::vector<Triangle>&, std::vector<Triangle>&, std::vector<Triangle>&) ;
+	constexpr static Box 	box_and_split( const Triangle *, size_t *, size_t *, size_t *& ) ;
+	constexpr static Box 	box_and_split( const Box *, const Point *, size_t *, size_t *, size_t *& ) ;
+	private :
+	constexpr bool 			clip		( const Point&, const Vector&, double &, double & ) const;
 };
 
-bool 
+constexpr double
+Box::surface_area() const
+{
+	const Vector S { _min, _max };
+	return 2.*(S.x()*S.y()+S.y()*S.z()+S.z()*S.x());
+};
+
+constexpr bool 
 Box::intersect( const Ray & r ) const
 {
-	const double tiny { 3e-7 };
-	Point t0 { (_min-r.origin()) / r.direction() }; // Elementwise division
-	Point t1 { (_max-r.origin()) / r.direction() }; // Elementwise division
-	Point tin  = emin(t0,t1);
-	Point tout = emax(t0,t1);
-	double tmin = std::max(tin[0], std::max(tin[1], tin[2]));
-	double tmax = std::min(tout[0], std::min(tout[1], tout[2]));
-	return ( (tmin-tiny) < (tmax+tiny));
+	return intersect(r.origin(),r.direction());
 };
-bool 
+constexpr bool 
 Box::intersect( const Point&p, const Vector&v ) const
 {
-	return intersect(Ray(p,v));
+	// Along the whole line
+	double tmin { -DBL_MAX }, tmax { DBL_MAX };
+	return clip(p,v,tmin,tmax);
+};
+constexpr bool 
+Box::entry( const Point&p, const Vector&v, double&t ) const
+{
+	// Along the ray only, t >= 0: where it enters the box, 0 if it starts inside
+	double tmin { 0. }, tmax { DBL_MAX };
+	if ( !clip(p,v,tmin,tmax) ) return false;
+	t = tmin;
+	return true;
+};
+constexpr bool 
+Box::clip( const Point&p, const Vector&v, double&tmin, double&tmax ) const
+{
+	// Slab test, narrowing [tmin,tmax]. Axes the line runs parallel to are tested directly,
+	// as dividing by their zero component is not a constant expression
+	const double tiny { 3e-7 };
+	for ( size_t i = 0; i < 3; ++i ) {
+		if ( v(i) == 0. ) {
+			if ( p(i) < _min(i) || p(i) > _max(i) ) return false;
+			continue;
+		}
+		const double t0 { (_min(i)-p(i)) / v(i) }, t1 { (_max(i)-p(i)) / v(i) };
+		tmin = std::max( tmin, std::min(t0,t1) );
+		tmax = std::min( tmax, std::max(t0,t1) );
+	}
+	return ( (tmin-tiny) < (tmax+tiny) );
 };
 
-Interval<Distance> 
+inline Interval<Distance> 
 Box::distance( const Point & query ) const
 {
 	// Distance has properties:
@@ -82,7 +117,7 @@ Box::distance( const Point & query ) const
 	return Interval<Distance> {Distance(dmin,true),Distance(dmax,true)};
 };
 
-void
+constexpr void
 Box::minmax_sq_dist( const Point & query , double&min, double&max) const
 {
 	const Point a = 0.5 * ( _max - _min );
@@ -101,20 +136,54 @@ Box::minmax_sq_dist( const Point & query , double&min, double&max) const
 	return;
 };
 
-Box 
-Box::box( const Triangle & t ) { return Box( t.pmin() , t.pmax() ); };
+constexpr Box 
+Box::box( const Triangle & t )
+{
+	// Component by component rather than through emin and emax, which is several times
+	// cheaper for constexpr evaluation
+	const Point a { t.vertex(0) }, b { t.vertex(1) }, c { t.vertex(2) };
+	return Box( Point( std::min({a.x(),b.x(),c.x()}), std::min({a.y(),b.y(),c.y()}), std::min({a.z(),b.z(),c.z()}) ),
+				Point( std::max({a.x(),b.x(),c.x()}), std::max({a.y(),b.y(),c.y()}), std::max({a.z(),b.z(),c.z()}) ) );
+};
 
-Box
+inline Box
 Box::box_and_split( const 	std::vector<Triangle> & invec,
 							std::vector<Triangle> & lvec,
 							std::vector<Triangle> & rvec )
 {
+	// Split an index range over the input and copy the two halves out
+	std::vector<size_t> index(invec.size());
+	for ( size_t k = 0; k < index.size(); ++k ) index[k] = k;
+	size_t * mid { nullptr };
+	Box b = box_and_split( invec.data(), index.data(), index.data()+index.size(), mid );
+	lvec.reserve( lvec.size() + (mid-index.data()) );
+	rvec.reserve( rvec.size() + (index.data()+index.size()-mid) );
+	for ( const size_t * k = index.data(); k != mid; ++k ) lvec.push_back(invec[*k]);
+	for ( const size_t * k = mid; k != index.data()+index.size(); ++k ) rvec.push_back(invec[*k]);
+	
+	// Make sure we got it right and return
+	assert(!lvec.empty());
+	assert(!rvec.empty());
+	assert(lvec.size()+rvec.size() == invec.size());
+	return b;
+};
+
+constexpr Box
+Box::box_and_split( const 	Triangle * triangles,
+							size_t * first,
+							size_t * last,
+							size_t *& mid )
+{
+	// Allocation-free version: [first,last) indexes into triangles and is partitioned
+	// in place, such that [first,mid) is the left and [mid,last) the right half
+	assert( last - first > 1 );
+	
 	// Find the bounds of the box by considering all triangles
 	Point box_pmin(+DBL_MAX,+DBL_MAX,+DBL_MAX);
 	Point box_pmax(-DBL_MAX,-DBL_MAX,-DBL_MAX);
-	for( Triangle t : invec ) {
-		box_pmin = emin( t.pmin(), box_pmin );
-		box_pmax = emax( t.pmax(), box_pmax );
+	for( const size_t * k = first; k != last; ++k ) {
+		box_pmin = emin( triangles[*k].pmin(), box_pmin );
+		box_pmax = emax( triangles[*k].pmax(), box_pmax );
 	}
 	// Construct diagonal vector, S, which spans the length of the box in all three directions
 	Vector S = box_pmax - box_pmin;
@@ -125,35 +194,53 @@ Box::box_and_split( const 	std::vector<Triangle> & invec,
 	int i { S.x()>S.y()?(S.x()>S.z()?0:2):(S.y()>S.z()?1:2) };
 	double thr = box_pmin(i) + S(i)/2.;
 	
-	// For returning a vertex as Box midpoint
-	// Initial closest midpoint, mid
-	// Box center, c
-	Point mid = invec[0].vertex(0);
-	Point c = box_pmin + S/2;
-	
-	for( Triangle t : invec ) {
-		// Assign all triangles to left or right based on triangle center coordinate
-		if( t.center()[i] > thr ) rvec.push_back(t); else lvec.push_back(t);
-		// Find the vertex closest to the box center
-		for ( Point p : t.vertices() ) if(Euclid::distance(c,p)<Euclid::distance(c,mid)) mid = p;
+	// Assign all triangles to left or right based on triangle center coordinate
+	mid = first;
+	for( size_t * k = first; k != last; ++k ) {
+		if( triangles[*k].center()(i) > thr ) continue;
+		size_t tmp { *k }; *k = *mid; *mid = tmp;
+		++mid;
 	}
 	
 	// Handle edge case where everything fell to one side
-	if( lvec.empty() || rvec.empty() ) {
-		size_t N = invec.size();
-		lvec.clear();
-		rvec.clear();
-		lvec.insert(lvec.end(), invec.begin(), invec.begin()+N/2);
-		rvec.insert(rvec.end(), invec.begin()+N/2, invec.end());
-	}
+	if( mid == first || mid == last ) mid = first + (last-first)/2;
 	
-	// Make sure we got it right and return
-	assert(!lvec.empty());
-	assert(!rvec.empty());
-	assert(lvec.size()+rvec.size() == invec.size());
 	return Box(box_pmin,box_pmax);
 };
-		
+
+constexpr Box
+Box::box_and_split( const 	Box * boxes,
+					const 	Point * centers,
+							size_t * first,
+							size_t * last,
+							size_t *& mid )
+{
+	// As above, from the boxes and centers of the triangles computed once up front,
+	// and component by component, which keeps constexpr builds within the limits
+	assert( last - first > 1 );
+	double lo[3] { +DBL_MAX, +DBL_MAX, +DBL_MAX };
+	double hi[3] { -DBL_MAX, -DBL_MAX, -DBL_MAX };
+	for( const size_t * k = first; k != last; ++k ) {
+		const Box & b { boxes[*k] };
+		lo[0] = std::min( lo[0], b._min.x() ); hi[0] = std::max( hi[0], b._max.x() );
+		lo[1] = std::min( lo[1], b._min.y() ); hi[1] = std::max( hi[1], b._max.y() );
+		lo[2] = std::min( lo[2], b._min.z() ); hi[2] = std::max( hi[2], b._max.z() );
+	}
+	const double S[3] { hi[0]-lo[0], hi[1]-lo[1], hi[2]-lo[2] };
+	const size_t i { S[0]>S[1]?(S[0]>S[2]?size_t(0):size_t(2)):(S[1]>S[2]?size_t(1):size_t(2)) };
+	const double thr { lo[i] + S[i]/2. };
+
+	mid = first;
+	for( size_t * k = first; k != last; ++k ) {
+		if( centers[*k][i] > thr ) continue;
+		size_t tmp { *k }; *k = *mid; *mid = tmp;
+		++mid;
+	}
+	if( mid == first || mid == last ) mid = first + (last-first)/2;
+
+	return Box( Point(lo[0],lo[1],lo[2]), Point(hi[0],hi[1],hi[2]) );
+};
+
 } // namespace Euclid
 
 #endif
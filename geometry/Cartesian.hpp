@@ -8,6 +8,8 @@
 #include <iostream>
 #include <math.h>
 
+#include "Expression.hpp"
+
 namespace Euclid {
 
 class Cartesian
@@ -20,14 +22,18 @@ class Cartesian
 	constexpr Cartesian	( const double & x, const double & y, const double & z ) : data({{x,y,z}}) {};
 	constexpr Cartesian	( const std::array<double,3> & A ) : data({{A[0],A[1],A[2]}}) {};
 	constexpr Cartesian	( const std::array<float,3> & A ) : data({{A[0],A[1],A[2]}}) {};
+	// Evaluate an expression in one pass. The three components are evaluated into
+	// arguments before any is stored, so the compiler can vectorise across them.
+	template<class E, typename = std::enable_if_t<is_expression_v<E>>>
+	constexpr Cartesian ( const E & e ) : Cartesian(e(0),e(1),e(2)) {};
 	
 	// Data access by indexing
 	// Const index operator []		-- access : return reference
 	// Non-const index operator []	-- access : return reference
 	// Const index operator ()		-- extraction : should not return a reference
 	// Non-const index operator ()	-- extraction : should not return a reference
-	const 		double &	operator [] ( size_t i ) const 	{ assert(i<3); return data[i]; }
-				double &	operator [] ( size_t i ) 		{ assert(i<3); return data[i]; }
+	constexpr const	double &	operator [] ( size_t i ) const 	{ assert(i<3); return data[i]; }
+	constexpr		double &	operator [] ( size_t i ) 		{ assert(i<3); return data[i]; }
 	constexpr 	double  	operator () ( size_t i ) const 	{ assert(i<3); return data[i]; }
 	
 	// Data extract (const) using identifiers
@@ -36,7 +42,7 @@ class Cartesian
 	constexpr double z	() 	const { return data[2]; };
 	
 	// Data assignment by index
-	const Cartesian &  set	( size_t i , double a ) { assert(i<3); data[i] = a; return *this; };
+	constexpr const Cartesian &  set	( size_t i , double a ) { assert(i<3); data[i] = a; return *this; };
 	
 	// Data assignment by istream
 	friend std::istream & operator >> ( std::istream & in, Cartesian & p)
@@ -60,51 +66,20 @@ class Cartesian
 	// Unary elementwise arithmetic
 	constexpr Cartesian operator - 	() { return Cartesian( -x(),-y(),-z() ); };
 	
-	// Binary elementwise arithmetic
-	constexpr Cartesian operator + ( const Cartesian & ) const;
-	constexpr Cartesian operator - ( const Cartesian & ) const;
-	constexpr Cartesian operator * ( const Cartesian & ) const;
-	constexpr Cartesian operator / ( const Cartesian & ) const;
-	constexpr Cartesian operator + ( const double & ) const;
-	constexpr Cartesian operator - ( const double & ) const; 
-	constexpr Cartesian operator * ( const double & ) const;
-	constexpr Cartesian operator / ( const double & ) const; 
+	// Binary elementwise arithmetic is lazy, see Expression.hpp
 
 	// Assignment operators
-	const Cartesian & 	operator +=	( const Cartesian & );
-	const Cartesian & 	operator -=	( const Cartesian & );
-	const Cartesian & 	operator *=	( const Cartesian & );
-	const Cartesian & 	operator /=	( const Cartesian & );
-	const Cartesian & 	operator +=	( const double & );
-	const Cartesian & 	operator -=	( const double & );
-	const Cartesian & 	operator *=	( const double & );
-	const Cartesian & 	operator /=	( const double & );
+	// Every expression node is elementwise, so evaluating in place is alias-safe
+	template<class E> const Cartesian & 	operator +=	( const E & e ) { for (size_t i=0; i<3; ++i) data[i] += component(e,i); return *this; };
+	template<class E> const Cartesian & 	operator -=	( const E & e ) { for (size_t i=0; i<3; ++i) data[i] -= component(e,i); return *this; };
+	template<class E> const Cartesian & 	operator *=	( const E & e ) { for (size_t i=0; i<3; ++i) data[i] *= component(e,i); return *this; };
+	template<class E> const Cartesian & 	operator /=	( const E & e ) { for (size_t i=0; i<3; ++i) data[i] /= component(e,i); return *this; };
 	
 	constexpr double 		major		( ); // largest absolute-value coordinate
 	constexpr double 		minor		( ); // smallest absolute-value coordinate
 	
 }; // class Cartesian
 
-// Binary elementwise arithmetic
-constexpr Cartesian 	Cartesian::operator + ( const Cartesian & other ) const { return Cartesian(x()+other.x(),y()+other.y(),z()+other.z()); };
-constexpr Cartesian 	Cartesian::operator - ( const Cartesian & other ) const { return Cartesian(x()-other.x(),y()-other.y(),z()-other.z()); };
-constexpr Cartesian 	Cartesian::operator * ( const Cartesian & other ) const { return Cartesian(x()*other.x(),y()*other.y(),z()*other.z()); };
-constexpr Cartesian 	Cartesian::operator / ( const Cartesian & other ) const { return Cartesian(x()/other.x(),y()/other.y(),z()/other.z()); };
-constexpr Cartesian 	Cartesian::operator + ( const double & a ) const { return Cartesian( x() + a, y() + a, z() + a ); };
-constexpr Cartesian 	Cartesian::operator - ( const double & a ) const { return Cartesian( x() - a, y() - a, z() - a ); }; 
-constexpr Cartesian 	Cartesian::operator * ( const double & a ) const { return Cartesian( x() * a, y() * a, z() * a ); };
-constexpr Cartesian 	Cartesian::operator / ( const double & a ) const { return Cartesian( x() / a, y() / a, z() / a ); }; 
-
-// Assigning operators
-const Cartesian & 	Cartesian::operator += ( const Cartesian & v ) { data[0] += v.x(); data[1] += v.y(); data[2] += v.z(); return *this; };
-const Cartesian & 	Cartesian::operator -= ( const Cartesian & v ) { data[0] -= v.x(); data[1] -= v.y(); data[2] -= v.z(); return *this; };
-const Cartesian & 	Cartesian::operator *= ( const Cartesian & v ) { data[0] *= v.x(); data[1] *= v.y(); data[2] *= v.z(); return *this; };
-const Cartesian & 	Cartesian::operator /= ( const Cartesian & v ) { data[0] /= v.x(); data[1] /= v.y(); data[2] /= v.z(); return *this; };
-const Cartesian & 	Cartesian::operator += ( const double & a ) { data[0] += a; data[1] += a; data[2] += a; return *this; }
-const Cartesian & 	Cartesian::operator -= ( const double & a ) { data[0] -= a; data[1] -= a; data[2] -= a; return *this; }
-const Cartesian & 	Cartesian::operator *= ( const double & a ) { data[0] *= a; data[1] *= a; data[2] *= a; return *this; }
-const Cartesian & 	Cartesian::operator /= ( const double & a ) { data[0] /= a; data[1] /= a; data[2] /= a; return *this; }
-
 // Major, minor: largest and smallest absolute value of individual coordinate
 constexpr double Cartesian::major() { return std::max(std::max(std::abs(x()),std::abs(y())),std::abs(z())); }
 constexpr double Cartesian::minor() { return std::min(std::min(std::abs(x()),std::abs(y())),std::abs(z())); }
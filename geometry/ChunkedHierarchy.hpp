@@ -0,0 +1,728 @@
+#ifndef EUCLID_GEOMETRY_CHUNKEDHIERARCHY
+#define EUCLID_GEOMETRY_CHUNKEDHIERARCHY
+
+// Out-of-core hierarchy for meshes larger than memory, in two levels. build splits the
+// triangles into spatially compact chunks of bounded size and writes each chunk, its own
+// bounding box hierarchy included, to one file. A ChunkedHierarchy keeps only the chunk
+// directory and a small tree over the chunk boxes in memory, and memory maps chunks as
+// queries reach them. A bounded LRU cache holds the mapped chunks: when a new chunk does
+// not fit, the least recently used ones are unmapped. Batch queries are answered chunk by
+// chunk rather than query by query, so each chunk is paged in about once per batch.
+// The cache counts hits, misses (page-ins) and evictions, to size it per host.
+// Queries change the cache, so a ChunkedHierarchy is used by one thread at a time.
+//
+// The build reads the input a few times in sequence and never holds more than one chunk:
+// centroids are binned on a 16^3 grid, runs of cells in Morton order are gathered into
+// groups of up to chunk_size triangles and written to temporary files next to the output,
+// and groups that are still too large are split again the same way. Temporary files get
+// unique names and are removed when done with, or when the build fails.
+// Data is stored as packed doubles and integers in the native layout of the platform.
+// Uses POSIX memory mapping, I/O failures throw std::system_error. The Geometry header
+// only includes this file where <sys/mman.h> is available.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Ray.hpp"
+#include "Box.hpp"
+#include "Traversal.hpp"
+#include "Hierarchy.hpp"
+
+namespace Euclid {
+
+// Read-only memory mapping of a whole file or a page aligned range of one
+class Mapping {
+	public :
+	Mapping ( ) {}
+	Mapping ( int fd, size_t offset, size_t length );
+	explicit Mapping ( const std::string & path );
+	Mapping ( Mapping && m ) noexcept : _addr(m._addr), _length(m._length) { m._addr = nullptr; m._length = 0; }
+	Mapping & operator = ( Mapping && m ) noexcept { std::swap(_addr,m._addr); std::swap(_length,m._length); return *this; }
+	Mapping ( const Mapping & ) = delete;
+	Mapping & operator = ( const Mapping & ) = delete;
+	~Mapping ( ) { if ( _addr ) munmap( _addr, _length ); }
+
+	const std::byte * 	data 	( ) const { return static_cast<const std::byte*>(_addr); }
+	size_t 				size 	( ) const { return _length; }
+	// Ask the system to start reading the pages in
+	void 				prefetch ( ) const { if ( _addr ) madvise( _addr, _length, MADV_WILLNEED ); }
+
+	private :
+	void * 	_addr { nullptr };
+	size_t 	_length { 0 };
+};
+
+inline
+Mapping::Mapping ( int fd, size_t offset, size_t length ) : _length(length)
+{
+	if ( length == 0 ) return;
+	_addr = mmap( nullptr, length, PROT_READ, MAP_SHARED, fd, off_t(offset) );
+	if ( _addr == MAP_FAILED ) { _addr = nullptr; throw std::system_error( errno, std::system_category(), "mmap" ); }
+};
+
+inline
+Mapping::Mapping ( const std::string & path )
+{
+	const int fd { open( path.c_str(), O_RDONLY ) };
+	if ( fd < 0 ) throw std::system_error( errno, std::system_category(), "open " + path );
+	struct stat st;
+	if ( fstat( fd, &st ) != 0 ) { const int e { errno }; close(fd); throw std::system_error( e, std::system_category(), "stat " + path ); }
+	try { *this = Mapping( fd, 0, size_t(st.st_size) ); } catch ( ... ) { close(fd); throw; }
+	close(fd);
+};
+
+// Triangles stored as nine doubles each, the vertices one after the other, for instance a
+// Mapping of a raw triangle file. Indexing returns Triangle by value.
+struct PackedTriangles {
+	const double * 	data 	{ nullptr };
+	size_t 			count 	{ 0 };
+	PackedTriangles ( ) {}
+	PackedTriangles ( const double * d, size_t n ) : data(d), count(n) {}
+	explicit PackedTriangles ( const Mapping & m ) : data(reinterpret_cast<const double*>(m.data())), count(m.size()/(9*sizeof(double))) {}
+	Triangle operator [] ( size_t i ) const
+	{
+		const double * d { data + 9*i };
+		return Triangle( Point(d[0],d[1],d[2]), Point(d[3],d[4],d[5]), Point(d[6],d[7],d[8]) );
+	}
+	size_t size ( ) const { return count; }
+};
+
+class ChunkedHierarchy {
+	public :
+	using Node = HierarchyNode;
+	using Stack = Hierarchy::Stack;
+	// Directory entry of a chunk
+	struct Chunk {
+		double 		box[6] {}; // min and max corner
+		uint64_t 	offset { 0 }; // Page aligned
+		uint64_t 	bytes { 0 };
+		uint64_t 	triangles { 0 };
+	};
+
+	// Write the chunked hierarchy of N triangles to a file, with at most chunk_size triangles
+	// per chunk. T is any random access container of triangles, such as a std::vector, a
+	// pointer or PackedTriangles, and is read in sequence.
+	template<class Triangles>
+	static void build ( const std::string & path, const Triangles & T, size_t N, size_t chunk_size = size_t(1) << 20 );
+
+	// Open a file written by build, keeping at most cache_bytes of chunks mapped, except
+	// that the chunk in use is always mapped
+	explicit ChunkedHierarchy ( const std::string & path, size_t cache_bytes = size_t(1) << 30 );
+	ChunkedHierarchy ( const ChunkedHierarchy & ) = delete;
+	ChunkedHierarchy & operator = ( const ChunkedHierarchy & ) = delete;
+	~ChunkedHierarchy ( ) { _slots.clear(); close(_fd); }
+
+	// Data access
+	size_t 			size 		( ) const { return _size; }
+	size_t 			chunks 		( ) const { return _chunks.size(); }
+	const Chunk & 	chunk 		( size_t i ) const { return _chunks[i]; }
+	const Box & 	box 		( ) const { return _top[0].box; }
+
+	// Queries, triangle indices are those of the input to build
+	size_t 	closest_triangle	( const Point & );
+	Point 	closest_point		( const Point & );
+	bool 	distance			( const Point & , double&, double&);
+	bool 	intersect			( const Ray &, double & );
+	bool 	intersect			( const Point &, const Vector &, double & );
+
+	// Batch queries, answered chunk by chunk. The closest points of N points, and optionally
+	// their triangles; the nearest intersections of N rays, t only assigned where hit is true.
+	void 	closest_point		( const Point *, size_t, Point *, size_t * = nullptr );
+	void 	intersect			( const Point *, const Vector *, size_t, double *, bool * );
+
+	// Cache
+	size_t 	capacity 		( ) const { return _capacity; }
+	size_t 	resident 		( ) const { return _resident; } // Chunks mapped
+	size_t 	resident_bytes 	( ) const { return _resident_bytes; }
+
+	// Statistics, a miss maps a chunk
+	size_t 	hits		( ) const { return _hits; }
+	size_t 	misses		( ) const { return _misses; }
+	size_t 	evictions	( ) const { return _evictions; }
+	double 	hit_rate	( ) const { return _hits+_misses ? double(_hits)/double(_hits+_misses) : 0.; }
+	void 	clear_statistics ( ) { _hits = 0; _misses = 0; _evictions = 0; }
+
+	private :
+	constexpr static char 		magic[8] { 'E','U','C','L','I','D','C','H' };
+	constexpr static uint64_t 	version { 1 };
+	struct Header {
+		char 		magic[8];
+		uint64_t 	version;
+		uint64_t 	chunks;
+		uint64_t 	triangles;
+		uint64_t 	directory; // Offset of the chunk directory
+	};
+	// A chunk holds its nodes, then its triangles, then the input index of each triangle
+	struct PackedNode {
+		double 		box[6];
+		uint64_t 	right;
+		uint64_t 	triangle;
+	};
+	struct Nodes {
+		const PackedNode * data;
+		Node operator [] ( size_t i ) const
+		{
+			const PackedNode & n = data[i];
+			return Node { Box( Point(n.box[0],n.box[1],n.box[2]), Point(n.box[3],n.box[4],n.box[5]) ), size_t(n.right), size_t(n.triangle) };
+		}
+	};
+	struct View {
+		Nodes 				nodes;
+		PackedTriangles 	triangles;
+		const uint64_t * 	sources;
+	};
+	// Build input: a triangle and its index in the input to build
+	struct Record {
+		double 		v[9];
+		uint64_t 	source;
+	};
+	template<class Triangles> struct Input {
+		const Triangles & T;
+		Record operator () ( size_t i ) const
+		{
+			const Triangle t { T[i] };
+			Record r;
+			for ( size_t k = 0; k < 3; ++k ) for ( size_t a = 0; a < 3; ++a ) r.v[3*k+a] = t.vertex(k)(a);
+			r.source = i;
+			return r;
+		}
+	};
+	struct Records {
+		const Record * data;
+		Record operator () ( size_t i ) const { return data[i]; }
+	};
+	struct Builder {
+		int 				fd;
+		std::string 		path;
+		size_t 				chunk_size;
+		size_t 				page;
+		std::vector<Chunk> 	directory {};
+		uint64_t 			end { 0 };
+		std::vector<std::string> temporaries {}; // Part files not yet removed
+		std::string 		temporary 	( );
+		void 				remove 		( const std::string & );
+		template<class Get> void split ( const Get &, size_t );
+		template<class Get> void emit ( const Get &, size_t, size_t );
+	};
+	// The closest triangle found so far
+	struct Best {
+		double 					sq_dist { DBL_MAX };
+		uint64_t 				source { 0 };
+		std::optional<Triangle> triangle {};
+	};
+	// Mapped chunk, linked in LRU order
+	struct Slot {
+		Mapping map {};
+		size_t 	prev { 0 };
+		size_t 	next { 0 };
+	};
+
+	int 					_fd { -1 };
+	size_t 					_size { 0 };
+	std::vector<Chunk> 		_chunks;
+	std::vector<Node> 		_top; // Tree over the chunk boxes, leaves store the chunk index
+	std::vector<Slot> 		_slots; // Per chunk, and the list head last
+	size_t 					_capacity { 0 };
+	size_t 					_resident { 0 };
+	size_t 					_resident_bytes { 0 };
+	size_t 					_hits { 0 };
+	size_t 					_misses { 0 };
+	size_t 					_evictions { 0 };
+
+	static Box 		chunk_box 	( const Chunk & c ) { return Box( Point(c.box[0],c.box[1],c.box[2]), Point(c.box[3],c.box[4],c.box[5]) ); }
+	static double 	min_sq_dist ( const Box & b, const Point & p ) { double min_sq { 0. }, max_sq { 0. }; b.minmax_sq_dist( p, min_sq, max_sq ); return min_sq; }
+	static void 	write 		( int, const void *, size_t, uint64_t );
+	static void 	read 		( int, void *, size_t, uint64_t );
+	size_t 			build_top 	( size_t *, size_t *, size_t & );
+	View 			acquire 	( size_t );
+	void 			unlink 		( size_t c ) { _slots[_slots[c].prev].next = _slots[c].next; _slots[_slots[c].next].prev = _slots[c].prev; }
+	void 			push_front 	( size_t );
+	size_t 			home 		( const Point & ) const;
+	void 			search 		( size_t, const Point &, Best & );
+	void 			nearest 	( const Point &, Best & );
+};
+
+inline void
+ChunkedHierarchy::write ( int fd, const void * data, size_t bytes, uint64_t offset )
+{
+	const char * d { static_cast<const char*>(data) };
+	while ( bytes > 0 ) {
+		const ssize_t n { pwrite( fd, d, bytes, off_t(offset) ) };
+		if ( n < 0 && errno == EINTR ) continue;
+		if ( n <= 0 ) throw std::system_error( errno, std::system_category(), "write" );
+		d += n; bytes -= size_t(n); offset += uint64_t(n);
+	}
+};
+
+inline void
+ChunkedHierarchy::read ( int fd, void * data, size_t bytes, uint64_t offset )
+{
+	char * d { static_cast<char*>(data) };
+	while ( bytes > 0 ) {
+		const ssize_t n { pread( fd, d, bytes, off_t(offset) ) };
+		if ( n < 0 && errno == EINTR ) continue;
+		if ( n < 0 ) throw std::system_error( errno, std::system_category(), "read" );
+		if ( n == 0 ) throw std::system_error( EIO, std::system_category(), "read past end of file" );
+		d += n; bytes -= size_t(n); offset += uint64_t(n);
+	}
+};
+
+template<class Triangles>
+void
+ChunkedHierarchy::build ( const std::string & path, const Triangles & T, size_t N, size_t chunk_size )
+{
+	assert( N > 0 && chunk_size > 0 );
+	const int fd { open( path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644 ) };
+	if ( fd < 0 ) throw std::system_error( errno, std::system_category(), "open " + path );
+	Builder b { fd, path, chunk_size, size_t(sysconf(_SC_PAGESIZE)) };
+	b.end = b.page; // The header has the first page
+	try {
+		b.split( Input<Triangles>{T}, N );
+		Header h { {}, version, b.directory.size(), N, b.end };
+		std::memcpy( h.magic, magic, sizeof(magic) );
+		write( fd, b.directory.data(), b.directory.size()*sizeof(Chunk), b.end );
+		write( fd, &h, sizeof(h), 0 );
+	} catch ( ... ) {
+		for ( const std::string & name : b.temporaries ) ::unlink( name.c_str() );
+		close(fd);
+		throw;
+	}
+	if ( close(fd) != 0 ) throw std::system_error( errno, std::system_category(), "close " + path );
+};
+
+template<class Get>
+void
+ChunkedHierarchy::Builder::split ( const Get & get, size_t count )
+{
+	if ( count <= chunk_size ) { emit( get, 0, count ); return; }
+
+	// Bounds of the centroids
+	auto centroid = []( const Record & r ) { return Point( (r.v[0]+r.v[3]+r.v[6])/3., (r.v[1]+r.v[4]+r.v[7])/3., (r.v[2]+r.v[5]+r.v[8])/3. ); };
+	Point lo { +DBL_MAX }, hi { -DBL_MAX };
+	for ( size_t i = 0; i < count; ++i ) {
+		const Point c { centroid(get(i)) };
+		lo = emin(lo,c);
+		hi = emax(hi,c);
+	}
+
+	// Cells on a 16^3 grid, numbered in Morton order
+	auto cell = [&]( const Record & r ) {
+		const Point c { centroid(r) };
+		size_t m { 0 };
+		for ( size_t a = 0; a < 3; ++a ) {
+			const double extent { hi(a) - lo(a) };
+			const size_t q { extent > 0. ? std::min<size_t>( 15, size_t( (c(a)-lo(a)) / extent * 16. ) ) : 0 };
+			for ( size_t bit = 0; bit < 4; ++bit ) m |= ( (q >> bit) & 1 ) << ( 3*bit + a );
+		}
+		return m;
+	};
+	std::vector<size_t> counts( 4096, 0 );
+	for ( size_t i = 0; i < count; ++i ) ++counts[cell(get(i))];
+
+	// Consecutive cells make up groups of at most chunk_size triangles, except that a cell
+	// holding more is a group of its own, to be split again
+	std::vector<size_t> group( 4096, 0 );
+	size_t groups { 0 }, filled { 0 };
+	for ( size_t m = 0; m < 4096; ++m ) {
+		if ( counts[m] == 0 ) continue;
+		if ( filled > 0 && filled + counts[m] > chunk_size ) { ++groups; filled = 0; }
+		group[m] = groups;
+		filled += counts[m];
+	}
+	++groups;
+	if ( groups == 1 ) {
+		// All centroids coincide, so split in input order
+		for ( size_t first = 0; first < count; first += chunk_size ) emit( get, first, std::min( chunk_size, count-first ) );
+		return;
+	}
+
+	// Write the groups to temporary files, through a small buffer each. A file is created
+	// with a unique name on the first flush of its group.
+	constexpr size_t buffered { 256 };
+	std::vector<std::string> names( groups );
+	std::vector<Record> buffer( groups*buffered );
+	std::vector<size_t> fill( groups, 0 ), written( groups, 0 );
+	auto flush = [&]( size_t g ) {
+		if ( fill[g] == 0 ) return;
+		if ( names[g].empty() ) names[g] = temporary();
+		const int part { open( names[g].c_str(), O_WRONLY ) };
+		if ( part < 0 ) throw std::system_error( errno, std::system_category(), "open " + names[g] );
+		try { write( part, &buffer[g*buffered], fill[g]*sizeof(Record), written[g]*sizeof(Record) ); } catch ( ... ) { close(part); throw; }
+		close(part);
+		written[g] += fill[g];
+		fill[g] = 0;
+	};
+	for ( size_t i = 0; i < count; ++i ) {
+		const Record r { get(i) };
+		const size_t g { group[cell(r)] };
+		buffer[g*buffered + fill[g]++] = r;
+		if ( fill[g] == buffered ) flush(g);
+	}
+	for ( size_t g = 0; g < groups; ++g ) flush(g);
+	std::vector<Record>().swap(buffer);
+
+	// Each group in turn, its file removed as soon as it is mapped
+	for ( size_t g = 0; g < groups; ++g ) {
+		const Mapping m( names[g] );
+		remove( names[g] );
+		split( Records{ reinterpret_cast<const Record*>(m.data()) }, m.size()/sizeof(Record) );
+	}
+};
+
+inline std::string
+ChunkedHierarchy::Builder::temporary ( )
+{
+	// An empty file next to the output, named so as not to clash with files left behind
+	std::string name { path + ".partXXXXXX" };
+	const int fd { mkstemp( name.data() ) };
+	if ( fd < 0 ) throw std::system_error( errno, std::system_category(), "mkstemp " + name );
+	close(fd);
+	temporaries.push_back( name );
+	return name;
+};
+
+inline void
+ChunkedHierarchy::Builder::remove ( const std::string & name )
+{
+	::unlink( name.c_str() );
+	temporaries.erase( std::find( temporaries.begin(), temporaries.end(), name ) );
+};
+
+template<class Get>
+void
+ChunkedHierarchy::Builder::emit ( const Get & get, size_t first, size_t count )
+{
+	std::vector<Triangle> triangles;
+	std::vector<uint64_t> sources;
+	triangles.reserve(count);
+	sources.reserve(count);
+	for ( size_t i = first; i < first+count; ++i ) {
+		const Record r { get(i) };
+		triangles.emplace_back( Point(r.v[0],r.v[1],r.v[2]), Point(r.v[3],r.v[4],r.v[5]), Point(r.v[6],r.v[7],r.v[8]) );
+		sources.push_back( r.source );
+	}
+	const Hierarchy h( triangles );
+
+	// Nodes, triangles and sources packed one after the other
+	const size_t nodes { 2*count-1 };
+	std::vector<std::byte> data( nodes*sizeof(PackedNode) + count*( 9*sizeof(double) + sizeof(uint64_t) ) );
+	PackedNode * N { reinterpret_cast<PackedNode*>(data.data()) };
+	for ( size_t n = 0; n < nodes; ++n ) {
+		const Node & node = h.node(n);
+		N[n] = PackedNode { { node.box.min().x(), node.box.min().y(), node.box.min().z(), node.box.max().x(), node.box.max().y(), node.box.max().z() }, node.right, node.triangle };
+	}
+	double * V { reinterpret_cast<double*>( data.data() + nodes*sizeof(PackedNode) ) };
+	for ( size_t i = 0; i < count; ++i ) for ( size_t k = 0; k < 3; ++k ) for ( size_t a = 0; a < 3; ++a ) V[9*i+3*k+a] = triangles[i].vertex(k)(a);
+	std::memcpy( V + 9*count, sources.data(), count*sizeof(uint64_t) );
+	write( fd, data.data(), data.size(), end );
+
+	const Box & box = h.box();
+	directory.push_back( Chunk { { box.min().x(), box.min().y(), box.min().z(), box.max().x(), box.max().y(), box.max().z() }, end, data.size(), count } );
+	end = ( end + data.size() + page - 1 ) / page * page;
+};
+
+inline
+ChunkedHierarchy::ChunkedHierarchy ( const std::string & path, size_t cache_bytes ) : _capacity(cache_bytes)
+{
+	_fd = open( path.c_str(), O_RDONLY );
+	if ( _fd < 0 ) throw std::system_error( errno, std::system_category(), "open " + path );
+	try {
+		Header h;
+		read( _fd, &h, sizeof(h), 0 );
+		if ( std::memcmp( h.magic, magic, sizeof(magic) ) != 0 || h.version != version || h.chunks == 0 )
+			throw std::system_error( EINVAL, std::system_category(), "not a chunked hierarchy: " + path );
+		_size = h.triangles;
+		_chunks.resize( h.chunks );
+		read( _fd, _chunks.data(), _chunks.size()*sizeof(Chunk), h.directory );
+	} catch ( ... ) { close(_fd); throw; }
+
+	// Tree over the chunks
+	std::vector<size_t> index( chunks() );
+	for ( size_t i = 0; i < chunks(); ++i ) index[i] = i;
+	_top.resize( 2*chunks()-1 );
+	size_t next { 0 };
+	build_top( index.data(), index.data()+chunks(), next );
+
+	// Empty LRU list, its head is the last slot
+	_slots.resize( chunks()+1 );
+	_slots[chunks()].prev = _slots[chunks()].next = chunks();
+};
+
+inline size_t
+ChunkedHierarchy::build_top ( size_t * first, size_t * last, size_t & next )
+{
+	// Median split of the box centres along their longest axis
+	const size_t n { next++ };
+	Point lo { +DBL_MAX }, hi { -DBL_MAX }, clo { +DBL_MAX }, chi { -DBL_MAX };
+	for ( size_t * i = first; i < last; ++i ) {
+		const Box b { chunk_box(_chunks[*i]) };
+		lo = emin(lo,b.min());
+		hi = emax(hi,b.max());
+		clo = emin(clo,Point((b.min()+b.max())*0.5));
+		chi = emax(chi,Point((b.min()+b.max())*0.5));
+	}
+	_top[n].box = Box(lo,hi);
+	if ( last - first == 1 ) { _top[n].triangle = *first; return n; }
+	const Vector extent { clo, chi };
+	const size_t a { extent.x() >= extent.y() && extent.x() >= extent.z() ? size_t(0) : ( extent.y() >= extent.z() ? size_t(1) : size_t(2) ) };
+	size_t * mid { first + (last-first)/2 };
+	std::nth_element( first, mid, last, [&]( size_t i, size_t j ) { return _chunks[i].box[a] + _chunks[i].box[a+3] < _chunks[j].box[a] + _chunks[j].box[a+3]; } );
+	build_top( first, mid, next );
+	_top[n].right = build_top( mid, last, next );
+	return n;
+};
+
+inline void
+ChunkedHierarchy::push_front ( size_t c )
+{
+	const size_t head { chunks() };
+	_slots[c].prev = head;
+	_slots[c].next = _slots[head].next;
+	_slots[_slots[head].next].prev = c;
+	_slots[head].next = c;
+};
+
+inline ChunkedHierarchy::View
+ChunkedHierarchy::acquire ( size_t c )
+{
+	Slot & s = _slots[c];
+	if ( s.map.size() > 0 ) {
+		++_hits;
+		unlink(c);
+	}
+	else {
+		++_misses;
+		// Unmap the least recently used chunks until this one fits, or none are left
+		const size_t head { chunks() };
+		while ( _resident > 0 && _resident_bytes + _chunks[c].bytes > _capacity ) {
+			const size_t lru { _slots[head].prev };
+			unlink(lru);
+			_resident_bytes -= _slots[lru].map.size();
+			--_resident;
+			++_evictions;
+			_slots[lru].map = Mapping();
+		}
+		s.map = Mapping( _fd, _chunks[c].offset, _chunks[c].bytes );
+		s.map.prefetch();
+		_resident_bytes += s.map.size();
+		++_resident;
+	}
+	push_front(c);
+	const std::byte * d { s.map.data() };
+	const size_t n { _chunks[c].triangles };
+	const size_t nodes { (2*n-1)*sizeof(PackedNode) };
+	return View {
+		Nodes { reinterpret_cast<const PackedNode*>(d) },
+		PackedTriangles( reinterpret_cast<const double*>(d + nodes), n ),
+		reinterpret_cast<const uint64_t*>( d + nodes + 9*n*sizeof(double) ) };
+};
+
+inline size_t
+ChunkedHierarchy::home ( const Point & p ) const
+{
+	// The chunk with the nearest box, by branch and bound on the tree in memory
+	Stack stack;
+	size_t top { 0 };
+	stack[top++] = 0;
+	double best_sq { DBL_MAX };
+	size_t best { 0 };
+	while ( top > 0 ) {
+		const size_t n { stack[--top] };
+		const double min_sq { min_sq_dist( _top[n].box, p ) };
+		if ( min_sq >= best_sq ) continue;
+		if ( _top[n].leaf() ) { best_sq = min_sq; best = _top[n].triangle; continue; }
+		stack[top++] = _top[n].right;
+		stack[top++] = n + 1;
+	}
+	return best;
+};
+
+inline void
+ChunkedHierarchy::search ( size_t c, const Point & p, Best & best )
+{
+	const View v { acquire(c) };
+	Stack stack;
+	size_t local { 0 };
+	if ( closest_triangle_within( v.triangles, v.nodes, p, stack, best.sq_dist, local ) ) {
+		best.source = v.sources[local];
+		best.triangle = v.triangles[local];
+	}
+};
+
+inline void
+ChunkedHierarchy::nearest ( const Point & p, Best & best )
+{
+	Stack stack;
+	size_t top { 0 };
+	stack[top++] = 0;
+	while ( top > 0 ) {
+		const size_t n { stack[--top] };
+		const Node & node = _top[n];
+		if ( min_sq_dist( node.box, p ) > best.sq_dist ) continue;
+		if ( node.leaf() ) { search( node.triangle, p, best ); continue; }
+		// Nearest child first
+		if ( min_sq_dist( _top[n+1].box, p ) < min_sq_dist( _top[node.right].box, p ) ) { stack[top++] = node.right; stack[top++] = n + 1; }
+		else 																			 { stack[top++] = n + 1; stack[top++] = node.right; }
+	}
+};
+
+inline size_t
+ChunkedHierarchy::closest_triangle ( const Point & p )
+{
+	Best best;
+	nearest( p, best );
+	return size_t(best.source);
+};
+
+inline Point
+ChunkedHierarchy::closest_point ( const Point & p )
+{
+	Best best;
+	nearest( p, best );
+	return best.triangle->closest_point(p);
+};
+
+inline bool
+ChunkedHierarchy::distance ( const Point & p , double&sq_dist, double&sign)
+{
+	Best best;
+	nearest( p, best );
+	return best.triangle->distance(p,sq_dist,sign);
+};
+
+inline bool
+ChunkedHierarchy::intersect ( const Ray & r, double & t )
+{
+	return intersect(r.origin(),r.direction(),t);
+};
+
+inline bool
+ChunkedHierarchy::intersect ( const Point & src, const Vector & dir, double & t )
+{
+	// Chunks in the order the ray enters them, as near as a depth first walk allows, and
+	// none that it enters beyond the nearest hit so far
+	Stack stack;
+	std::array<double,std::tuple_size<Stack>::value> enter {};
+	size_t top { 0 };
+	double e { 0. };
+	if ( !_top[0].box.entry(src,dir,e) ) return false;
+	stack[top] = 0;
+	enter[top++] = e;
+	bool hit { false };
+	while ( top > 0 ) {
+		--top;
+		const size_t n { stack[top] };
+		if ( hit && enter[top] > t ) continue;
+		const Node & node = _top[n];
+		if ( node.leaf() ) {
+			const View v { acquire(node.triangle) };
+			Stack inner;
+			double s { 0. };
+			if ( Euclid::intersect( v.triangles, v.nodes, src, dir, s, inner ) && ( !hit || s < t ) ) { t = s; hit = true; }
+			continue;
+		}
+		double el { 0. }, er { 0. };
+		const bool l { _top[n+1].box.entry(src,dir,el) }, r { _top[node.right].box.entry(src,dir,er) };
+		// Nearest entry on top
+		if ( l && r && el > er ) { stack[top] = n + 1; enter[top++] = el; stack[top] = node.right; enter[top++] = er; continue; }
+		if ( r ) { stack[top] = node.right; enter[top++] = er; }
+		if ( l ) { stack[top] = n + 1; enter[top++] = el; }
+	}
+	return hit;
+};
+
+inline void
+ChunkedHierarchy::closest_point ( const Point * P, size_t N, Point * closest, size_t * index )
+{
+	// First every query searches the chunk with its nearest box, which usually holds the
+	// answer, then the other chunks still within reach. Both passes run through the
+	// (chunk,query) pairs sorted by chunk.
+	std::vector<Best> best( N );
+	std::vector<size_t> first( N );
+	std::vector<std::pair<size_t,size_t>> pairs( N );
+	for ( size_t q = 0; q < N; ++q ) pairs[q] = { first[q] = home(P[q]), q };
+	std::sort( pairs.begin(), pairs.end() );
+	for ( const auto & [c,q] : pairs ) search( c, P[q], best[q] );
+
+	pairs.clear();
+	Stack stack;
+	for ( size_t q = 0; q < N; ++q ) {
+		size_t top { 0 };
+		stack[top++] = 0;
+		while ( top > 0 ) {
+			const size_t n { stack[--top] };
+			if ( min_sq_dist( _top[n].box, P[q] ) >= best[q].sq_dist ) continue;
+			if ( !_top[n].leaf() ) { stack[top++] = _top[n].right; stack[top++] = n + 1; continue; }
+			if ( _top[n].triangle != first[q] ) pairs.emplace_back( _top[n].triangle, q );
+		}
+	}
+	std::sort( pairs.begin(), pairs.end() );
+	for ( const auto & [c,q] : pairs ) if ( min_sq_dist( chunk_box(_chunks[c]), P[q] ) < best[q].sq_dist ) search( c, P[q], best[q] );
+
+	for ( size_t q = 0; q < N; ++q ) {
+		closest[q] = best[q].triangle->closest_point(P[q]);
+		if ( index ) index[q] = size_t(best[q].source);
+	}
+};
+
+inline void
+ChunkedHierarchy::intersect ( const Point * src, const Vector * dir, size_t N, double * t, bool * hit )
+{
+	// The (chunk,ray) pairs of every chunk a ray enters, with the distance at which it
+	// does, sorted by chunk so each chunk is paged in once. A pair is skipped if the ray
+	// already hit something nearer than where it enters the chunk.
+	struct Pair {
+		size_t 	chunk;
+		size_t 	query;
+		double 	enter;
+		bool operator < ( const Pair & o ) const { return chunk < o.chunk || ( chunk == o.chunk && query < o.query ); }
+	};
+	std::vector<Pair> pairs;
+	Stack stack;
+	for ( size_t q = 0; q < N; ++q ) {
+		hit[q] = false;
+		size_t top { 0 };
+		stack[top++] = 0;
+		while ( top > 0 ) {
+			const size_t n { stack[--top] };
+			double e { 0. };
+			if ( !_top[n].box.entry(src[q],dir[q],e) ) continue;
+			if ( _top[n].leaf() ) { pairs.push_back( Pair { _top[n].triangle, q, e } ); continue; }
+			stack[top++] = _top[n].right;
+			stack[top++] = n + 1;
+		}
+	}
+	std::sort( pairs.begin(), pairs.end() );
+	for ( const Pair & p : pairs ) {
+		const size_t q { p.query };
+		if ( hit[q] && p.enter > t[q] ) continue;
+		const View v { acquire(p.chunk) };
+		double s { 0. };
+		if ( Euclid::intersect( v.triangles, v.nodes, src[q], dir[q], s, stack ) && ( !hit[q] || s < t[q] ) ) { t[q] = s; hit[q] = true; }
+	}
+};
+
+} // namespace Euclid
+
+#endif
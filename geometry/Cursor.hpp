@@ -0,0 +1,170 @@
+#ifndef EUCLID_GEOMETRY_CURSOR
+#define EUCLID_GEOMETRY_CURSOR
+
+// Stateful closest point queries for sequences of nearby points, such as densely sampled paths.
+// Each query first tests the previous closest triangle, which gives an upper bound on the
+// distance that is usually already the answer. After a full traversal the cursor caches
+// the leaves whose boxes come within radius R of the query point, R being the closest
+// distance plus a margin sized from the movement between queries, sorted by distance to
+// that centre. A following query at distance delta from the centre tests the cached leaves
+// in that order, box first, and stops at the first that cannot beat the bound: one at
+// distance m from the centre is at least m - delta from the query. If the best found is at distance
+// d with d + delta < R, every closer triangle would have to lie inside the cached ball,
+// so the result is exact and no tree traversal is needed: a warm start hit. Otherwise the
+// query falls back to a full traversal seeded with d as upper bound, and the cache is
+// rebuilt around the new point.
+// Works with any hierarchy exposing node(i), triangle(i) and a Stack type deep enough
+// for its tree, ie. Hierarchy and StaticHierarchy.
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Traversal.hpp"
+
+namespace Euclid {
+
+template<class H, size_t K = 32>
+class Cursor {
+	public :
+	Cursor ( const H & h ) : _h(h) {};
+
+	// Queries
+	size_t 	closest_triangle	( const Point & );
+	Point 	closest_point		( const Point & p ) { return _h.triangle(closest_triangle(p)).closest_point(p); };
+	bool 	distance			( const Point & p, double&sq_dist, double&sign) { return _h.triangle(closest_triangle(p)).distance(p,sq_dist,sign); };
+
+	// Forget previous queries, the next one starts cold from the root
+	void 	reset				( ) { _count = 0; _radius = -1.; _warm = false; };
+
+	// Statistics, over all queries
+	size_t 	queries		( ) const { return _queries; }
+	size_t 	hits		( ) const { return _hits; }
+	double 	hit_rate	( ) const { return _queries ? double(_hits)/double(_queries) : 0.; }
+	size_t 	visits		( ) const { return _visits; } // Node boxes tested, in traversals, cache rebuilds and cached leaves
+	size_t 	tests		( ) const { return _tests; } // Triangle distance evaluations
+	void 	clear_statistics ( ) { _queries = 0; _hits = 0; _visits = 0; _tests = 0; }
+
+	private :
+	const H & 				_h;
+	std::array<size_t,K> 	_leaves {}; // Cached leaf nodes
+	std::array<double,K> 	_leaf_sq {}; // Their squared min distance to _centre, ascending
+	size_t 					_count { 0 };
+	Point 					_centre;
+	double 					_radius { -1. }; // Negative if nothing is cached
+	Point 					_last;
+	size_t 					_best { 0 }; // Closest triangle of the last query
+	bool 					_warm { false };
+	size_t 					_queries { 0 };
+	size_t 					_hits { 0 };
+	size_t 					_visits { 0 };
+	size_t 					_tests { 0 };
+	void collect ( const Point &, double );
+
+	// Views of the hierarchy for the shared traversal, counting triangle and box tests
+	struct Triangles { const H & h; size_t & tests; const Triangle & operator[] ( size_t i ) const { ++tests; return h.triangle(i); } };
+	struct Nodes { const H & h; const HierarchyNode & operator[] ( size_t i ) const { return h.node(i); } };
+	struct Bounds {
+		size_t & visits;
+		double min_sq_dist ( const HierarchyNode & node, size_t n, const Point & p, double limit ) const { ++visits; return BoxBounds().min_sq_dist( node, n, p, limit ); }
+		bool intersect ( const HierarchyNode & node, size_t n, const Point & src, const Vector & dir ) const { ++visits; return BoxBounds().intersect( node, n, src, dir ); }
+	};
+};
+
+template<class H, size_t K>
+size_t
+Cursor<H,K>::closest_triangle ( const Point & p )
+{
+	++_queries;
+	double best_sq { DBL_MAX };
+	size_t best { 0 };
+
+	// Upper bound from the previous closest triangle
+	if ( _warm ) {
+		++_tests;
+		best = _best;
+		best_sq = Vector( p , _h.triangle(best).closest_point(p) ).norm();
+	}
+
+	// Warm start from the cached leaves, nearest first
+	if ( _radius >= 0. ) {
+		const double delta { Vector(_centre,p).length() };
+		for ( size_t k = 0; k < _count; ++k ) {
+			const double lower { std::max( 0., sqrt(_leaf_sq[k]) - delta ) };
+			if ( lower*lower >= best_sq ) break;
+			const HierarchyNode & node = _h.node(_leaves[k]);
+			if ( node.triangle == _best ) continue;
+			++_visits;
+			double min_sq { 0. }, max_sq { 0. };
+			node.box.minmax_sq_dist( p, min_sq, max_sq );
+			if ( min_sq >= best_sq ) continue;
+			const size_t t { node.triangle };
+			++_tests;
+			double sq_dist { Vector( p , _h.triangle(t).closest_point(p) ).norm() };
+			if ( sq_dist < best_sq ) { best_sq = sq_dist; best = t; }
+		}
+		if ( sqrt(best_sq) + delta < _radius ) {
+			++_hits;
+			_last = p;
+			_best = best;
+			return best;
+		}
+	}
+
+	// Fall back to a full traversal, seeded with the best so far
+	typename H::Stack stack;
+	closest_triangle_within( Triangles{_h,_tests}, Nodes{_h}, p, stack, best_sq, best, Bounds{_visits} );
+	double step { _warm ? Vector(_last,p).length() : 0. };
+	double r { sqrt(best_sq) };
+	collect( p, r + std::max( 0.25*r, 4.*step ) );
+	_last = p;
+	_best = best;
+	_warm = true;
+	return best;
+};
+
+// Cache the leaves whose boxes come within the radius of the centre, nearest first.
+// If more than K do, keep the K nearest and shrink the radius to the nearest one left out.
+template<class H, size_t K>
+void
+Cursor<H,K>::collect ( const Point & centre, double radius )
+{
+	_centre = centre;
+	_count = 0;
+	double radius_sq { radius*radius };
+	typename H::Stack stack;
+	size_t top { 0 };
+	stack[top++] = 0;
+	while ( top > 0 ) {
+		const size_t n { stack[--top] };
+		const HierarchyNode & node = _h.node(n);
+		++_visits;
+		double min_sq { 0. }, max_sq { 0. };
+		node.box.minmax_sq_dist( centre, min_sq, max_sq );
+		if ( min_sq >= radius_sq ) continue;
+		if ( !node.leaf() ) { stack[top++] = node.right; stack[top++] = n+1; continue; }
+		if ( _count < K ) { _leaves[_count] = n; _leaf_sq[_count++] = min_sq; continue; }
+		// Full: leave out the farthest of the cached leaves and this one
+		size_t far { 0 };
+		for ( size_t k = 1; k < K; ++k ) if ( _leaf_sq[k] > _leaf_sq[far] ) far = k;
+		if ( min_sq < _leaf_sq[far] ) { _leaves[far] = n; std::swap( _leaf_sq[far], min_sq ); }
+		radius_sq = std::min( radius_sq, min_sq );
+	}
+	_radius = sqrt(radius_sq);
+	// Insertion sort, K is small
+	for ( size_t k = 1; k < _count; ++k ) {
+		for ( size_t j = k; j > 0 && _leaf_sq[j] < _leaf_sq[j-1]; --j ) {
+			std::swap( _leaf_sq[j], _leaf_sq[j-1] );
+			std::swap( _leaves[j], _leaves[j-1] );
+		}
+	}
+};
+
+} // namespace Euclid
+
+#endif
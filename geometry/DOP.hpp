@@ -0,0 +1,276 @@
+#ifndef EUCLID_GEOMETRY_DOP
+#define EUCLID_GEOMETRY_DOP
+
+// Discrete oriented polytope: the intersection of K/2 slabs with fixed normals.
+// 14-DOP: the three axes and the four cube diagonals
+// 18-DOP: the three axes and the six face diagonals
+// 26-DOP: all of the above
+// The first three slabs always form the axis aligned box.
+// Distances are exact. The nearest point is found by an active set method over the faces,
+// a few passes over the slabs, the farthest point by clipping every face to a polygon,
+// which is much costlier, so min_sq_dist is offered on its own for culling.
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Ray.hpp"
+
+namespace Euclid {
+
+template<size_t K>
+class DOP {
+	static_assert( K == 14 || K == 18 || K == 26 , "DOP is defined for K = 14, 18 or 26" );
+	public :
+	constexpr static size_t slabs { K/2 };
+	// Slab normals, not normalised
+	constexpr static Vector direction ( size_t i ) { const size_t j { table(i) }; return Vector( _d[j][0], _d[j][1], _d[j][2] ); }
+	// 1 / direction(i).length()
+	constexpr static double inverse_length ( size_t i ) { const size_t j { table(i) }; return j < 3 ? 1. : ( j < 7 ? 0.57735026918962576 : 0.70710678118654752 ); }
+
+	constexpr DOP() {}
+	static DOP 	fit ( const Point *, size_t );
+
+	// Data access, extent of slab i along direction(i)
+	constexpr double 	min		( size_t i ) const { return _min[i]; }
+	constexpr double 	max		( size_t i ) const { return _max[i]; }
+
+	// Properties
+	double 				surface_area	( ) const;
+
+	// Exact squared distances from a point to the nearest and farthest point of the polytope,
+	// min_sq_dist returns early with some value above limit if the distance exceeds it
+	void 				minmax_sq_dist	( const Point &, double&, double& ) const;
+	double 				min_sq_dist		( const Point &, double limit = DBL_MAX ) const;
+	double 				max_sq_dist		( const Point & ) const;
+	// Whether the ray, ie. points src+t*dir with t >= 0, meets the polytope
+	constexpr bool 		intersect		( const Ray & ) const;
+	constexpr bool 		intersect		( const Point &, const Vector & ) const;
+
+	private :
+	constexpr static double _d[13][3] {
+		{1,0,0}, {0,1,0}, {0,0,1},
+		{1,1,1}, {1,1,-1}, {1,-1,1}, {1,-1,-1},
+		{1,1,0}, {1,-1,0}, {1,0,1}, {1,0,-1}, {0,1,1}, {0,1,-1} };
+	// Row of _d for slab i, the 18-DOP skips the cube diagonals
+	constexpr static size_t table ( size_t i ) { return K == 18 && i >= 3 ? i+4 : i; }
+	std::array<double,K/2> _min {};
+	std::array<double,K/2> _max {};
+
+	// Halfspace i: dot(normal(i),x) <= offset(i)
+	constexpr Vector 	normal	( size_t i ) const { return i < slabs ? direction(i) : -direction(i-slabs); }
+	constexpr double 	offset	( size_t i ) const { return i < slabs ? _max[i] : -_min[i-slabs]; }
+	bool 				project	( const Point &, const size_t *, size_t, Point & ) const;
+	template<class F> void faces ( const F & ) const;
+};
+
+template<size_t K>
+DOP<K>
+DOP<K>::fit( const Point * P, size_t N )
+{
+	DOP<K> b;
+	for ( size_t i = 0; i < slabs; ++i ) { b._min[i] = +DBL_MAX; b._max[i] = -DBL_MAX; }
+	for ( size_t k = 0; k < N; ++k ) for ( size_t i = 0; i < slabs; ++i ) {
+		double d { dot(Vector(P[k]),direction(i)) };
+		b._min[i] = std::min(b._min[i],d);
+		b._max[i] = std::max(b._max[i],d);
+	}
+	return b;
+};
+
+template<size_t K>
+bool
+DOP<K>::project( const Point & p, const size_t * S, size_t count, Point & x ) const
+{
+	// Nearest point to p on the planes of S: p - x = sum of l_i n_i, with every l_i >= 0
+	if ( count == 1 ) {
+		const Vector n { normal(S[0]) };
+		const double l { ( dot(n,Vector(p)) - offset(S[0]) ) / n.norm() };
+		x = p - n*l;
+		return l >= 0.;
+	}
+	if ( count == 2 ) {
+		const Vector ni { normal(S[0]) }, nj { normal(S[1]) };
+		const double a { ni.norm() }, b { dot(ni,nj) }, c { nj.norm() };
+		const double det { a*c - b*b };
+		if ( det < 1e-12 * a * c ) return false;
+		const double ri { dot(ni,Vector(p)) - offset(S[0]) }, rj { dot(nj,Vector(p)) - offset(S[1]) };
+		const double li { ( c*ri - b*rj ) / det }, lj { ( a*rj - b*ri ) / det };
+		x = p - ni*li - nj*lj;
+		return li >= 0. && lj >= 0.;
+	}
+	const Vector ni { normal(S[0]) }, nj { normal(S[1]) }, nk { normal(S[2]) };
+	const double det { dot( ni, cross(nj,nk) ) };
+	if ( std::abs(det) < 1e-12 ) return false;
+	// Vertex by Cramer's rule, then the multipliers from p - x = [ni nj nk] l
+	x = Point( ( cross(nj,nk)*offset(S[0]) + cross(nk,ni)*offset(S[1]) + cross(ni,nj)*offset(S[2]) ) / det );
+	const Vector r { x, p };
+	const double eps { -1e-12 * r.norm() };
+	return dot( r, cross(nj,nk) ) / det >= eps && dot( r, cross(nk,ni) ) / det >= eps && dot( r, cross(ni,nj) ) / det >= eps;
+};
+
+template<size_t K>
+double
+DOP<K>::min_sq_dist( const Point & p, double limit ) const
+{
+	// Dual active set method. x is the nearest point to p in the intersection of the
+	// halfspaces in A, at most three. While x violates some halfspace j, x moves to the
+	// nearest point in the intersection of A and j, found by trying the subsets of A that
+	// contain j. The distance grows at every step, so no active set repeats and the loop
+	// ends; the distance is a lower bound throughout, so the search stops once it passes limit.
+
+	// Distance of x outside the halfspaces of slab i, less a tolerance for points on the planes
+	auto excess = [this]( size_t i, const Point & x, double & hi, double & lo ) {
+		const double d { dot(direction(i),Vector(x)) };
+		const double tol { 1e-9 * ( 1. + std::max( std::abs(_min[i]), std::abs(_max[i]) ) ) };
+		hi = ( d - _max[i] ) * inverse_length(i) - tol;
+		lo = ( _min[i] - d ) * inverse_length(i) - tol;
+	};
+	Point x { p };
+	size_t A[4] {}, count { 0 };
+	for ( size_t step = 0; step < 4*K && Vector(p,x).norm() <= limit; ++step ) {
+		size_t j { K };
+		double worst { 0. };
+		for ( size_t i = 0; i < slabs; ++i ) {
+			double hi { 0. }, lo { 0. };
+			excess( i, x, hi, lo );
+			if ( hi > worst ) { worst = hi; j = i; }
+			if ( lo > worst ) { worst = lo; j = i+slabs; }
+		}
+		if ( j == K ) break;
+		A[count] = j;
+		// Subsets of A with j, smallest first
+		bool found { false };
+		for ( size_t size = 1; size <= 3 && !found; ++size ) {
+			for ( size_t mask = 0; mask < (size_t(1) << count) && !found; ++mask ) {
+				size_t S[3] { j }, n { 1 };
+				for ( size_t b = 0; b < count; ++b ) if ( mask & (size_t(1) << b) ) { if ( n == size ) { n = 0; break; } S[n++] = A[b]; }
+				if ( n != size ) continue;
+				Point y;
+				if ( !project( p, S, n, y ) ) continue;
+				bool feasible { true };
+				for ( size_t b = 0; b <= count && feasible; ++b ) {
+					double hi { 0. }, lo { 0. };
+					excess( A[b] % slabs, y, hi, lo );
+					feasible = ( A[b] < slabs ? hi : lo ) <= 0.;
+				}
+				if ( !feasible ) continue;
+				x = y;
+				for ( size_t b = 0; b < n; ++b ) A[b] = S[b];
+				count = n;
+				found = true;
+			}
+		}
+		// Degenerate planes: keep the lower bound reached so far
+		if ( !found ) break;
+	}
+	return Vector(p,x).norm();
+};
+
+// Call f(polygon,count,i) with the boundary polygon of every non-empty face i
+template<size_t K>
+template<class F>
+void
+DOP<K>::faces( const F & f ) const
+{
+	// Clip a large square in the plane of each face by all other halfspaces
+	double size { 1. };
+	for ( size_t a = 0; a < 3; ++a ) size = std::max( size, std::abs(_min[a]) + std::abs(_max[a]) );
+	size *= 4.;
+	for ( size_t i = 0; i < K; ++i ) {
+		const Vector n { normal(i).normalised() };
+		const Point o { n * ( offset(i) / normal(i).length() ) };
+		const Vector u { ( std::abs(n.x()) < 0.9 ? cross(n,Vector(1,0,0)) : cross(n,Vector(0,1,0)) ).normalised() };
+		const Vector v { cross(n,u) };
+		std::array<Point,K+4> poly { o - u*size - v*size, o + u*size - v*size, o + u*size + v*size, o - u*size + v*size };
+		size_t count { 4 };
+		for ( size_t j = 0; j < K && count > 0; ++j ) {
+			if ( j == i ) continue;
+			const Vector m { normal(j) };
+			const double h { offset(j) };
+			std::array<Point,K+4> out {};
+			size_t c { 0 };
+			for ( size_t k = 0; k < count; ++k ) {
+				const Point & A = poly[k];
+				const Point & B = poly[(k+1)%count];
+				const double da { dot(m,Vector(A)) - h }, db { dot(m,Vector(B)) - h };
+				if ( da <= 0. ) out[c++] = A;
+				if ( ( da < 0. && db > 0. ) || ( da > 0. && db < 0. ) ) out[c++] = A + Vector(A,B) * ( da / ( da - db ) );
+			}
+			poly = out;
+			count = c;
+		}
+		if ( count >= 3 ) f( poly, count, i );
+	}
+};
+
+template<size_t K>
+double
+DOP<K>::surface_area( ) const
+{
+	double area { 0. };
+	faces( [&]( const std::array<Point,K+4> & poly, size_t count, size_t ) {
+		Vector s { 0. };
+		for ( size_t k = 1; k+1 < count; ++k ) s += cross( Vector(poly[0],poly[k]), Vector(poly[0],poly[k+1]) );
+		area += 0.5 * s.length();
+	} );
+	return area;
+};
+
+template<size_t K>
+double
+DOP<K>::max_sq_dist( const Point & p ) const
+{
+	// The farthest point is a vertex, and every vertex lies on some face
+	double max { 0. };
+	faces( [&]( const std::array<Point,K+4> & poly, size_t count, size_t ) {
+		for ( size_t k = 0; k < count; ++k ) max = std::max( max, Vector(p,poly[k]).norm() );
+	} );
+	return max;
+};
+
+template<size_t K>
+void
+DOP<K>::minmax_sq_dist( const Point & p, double&min, double&max ) const
+{
+	min = min_sq_dist(p);
+	max = max_sq_dist(p);
+};
+
+template<size_t K>
+constexpr bool
+DOP<K>::intersect( const Ray & r ) const
+{
+	return intersect( r.origin(), r.direction() );
+};
+
+template<size_t K>
+constexpr bool
+DOP<K>::intersect( const Point & src, const Vector & dir ) const
+{
+	// Slab test over all slabs
+	const double tiny { 3e-7 };
+	double tmin { 0. }, tmax { DBL_MAX };
+	for ( size_t i = 0; i < slabs; ++i ) {
+		const Vector n { direction(i) };
+		double o { dot(Vector(src),n) };
+		double d { dot(dir,n) };
+		if ( d == 0. ) {
+			if ( o < _min[i]-tiny || o > _max[i]+tiny ) return false;
+			continue;
+		}
+		double t0 { (_min[i]-o) / d }, t1 { (_max[i]-o) / d };
+		if ( t0 > t1 ) { double t { t0 }; t0 = t1; t1 = t; }
+		tmin = std::max(tmin,t0);
+		tmax = std::min(tmax,t1);
+	}
+	return ( (tmin-tiny) < (tmax+tiny) );
+};
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef EUCLID_GEOMETRY_EXPRESSION
+#define EUCLID_GEOMETRY_EXPRESSION
+
+// Lazy elementwise arithmetic for Cartesian, Point and Vector.
+// An operator returns a small node which only records its operands. Nothing is
+// computed until the node is assigned to (or used to construct) a Cartesian type,
+// at which point every component of the whole expression is evaluated in a single pass.
+// Lvalue operands are held by reference, temporaries and scalars by value, so
+// `auto e = a + b;` is safe as long as a and b outlive e.
+// A node remembers the type it evaluates to (Point if any operand is a Point, else
+// Cartesian if any is a plain Cartesian, else Vector), and calling a member of that
+// type on the node, as in `(v*2.).length()`, evaluates it first.
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+namespace Euclid {
+
+class Cartesian;
+class Point;
+class Vector;
+
+// All expression nodes derive from this tag
+struct ExpressionBase {};
+
+template<class T> constexpr bool is_expression_v = std::is_base_of_v< ExpressionBase, std::decay_t<T> >;
+template<class T> constexpr bool is_cartesian_v  = std::is_base_of_v< Cartesian, std::decay_t<T> >;
+template<class T> constexpr bool is_scalar_v     = std::is_arithmetic_v< std::decay_t<T> >;
+template<class T> constexpr bool is_operand_v    = is_expression_v<T> || is_cartesian_v<T>;
+
+// Valid operand combinations: two Cartesian-like operands, or one of them and a scalar
+template<class L, class R> constexpr bool is_operand_pair_v =
+	( is_operand_v<L> && ( is_operand_v<R> || is_scalar_v<R> ) ) || ( is_scalar_v<L> && is_operand_v<R> );
+
+// How an operand is stored inside a node
+// Cartesian lvalue 	-- const reference
+// Cartesian rvalue 	-- copy (three doubles)
+// Expression 			-- copy (nodes are small)
+// Scalar 				-- double
+template<class T> using operand_t =
+	std::conditional_t< is_cartesian_v<T>,
+		std::conditional_t< std::is_lvalue_reference_v<T>, const Cartesian &, Cartesian >,
+		std::conditional_t< is_scalar_v<T>, double, std::decay_t<T> > >;
+
+// Component i of an operand, scalars broadcast
+template<class T>
+constexpr double component ( const T & t, size_t i )
+{
+	if constexpr ( std::is_arithmetic_v<T> ) return t;
+	else return t(i);
+}
+
+// Elementwise operations
+struct Add { static constexpr double apply ( double a, double b ) { return a + b; } };
+struct Sub { static constexpr double apply ( double a, double b ) { return a - b; } };
+struct Mul { static constexpr double apply ( double a, double b ) { return a * b; } };
+struct Div { static constexpr double apply ( double a, double b ) { return a / b; } };
+struct Min { static constexpr double apply ( double a, double b ) { return std::min(a,b); } };
+struct Max { static constexpr double apply ( double a, double b ) { return std::max(a,b); } };
+struct Neg { static constexpr double apply ( double a ) { return -a; } };
+
+// The type an operand evaluates to, void for scalars
+template<class T, class = void> struct evaluated { using type = void; };
+template<class T> struct evaluated< T, std::enable_if_t<is_cartesian_v<T>> >
+{
+	using type = std::conditional_t< std::is_same_v<std::decay_t<T>,Point> || std::is_same_v<std::decay_t<T>,Vector>, std::decay_t<T>, Cartesian >;
+};
+template<class T> struct evaluated< T, std::enable_if_t<is_expression_v<T>> > { using type = typename std::decay_t<T>::result_type; };
+template<class T> using evaluated_t = typename evaluated<T>::type;
+
+// The type a node evaluates to, following the eager operators these nodes replaced
+template<class L, class R, class A = evaluated_t<L>, class B = evaluated_t<R>> using result_t =
+	std::conditional_t< std::is_same_v<A,Point> || std::is_same_v<B,Point>, Point,
+	std::conditional_t< std::is_same_v<A,Cartesian> || std::is_same_v<B,Cartesian>, Cartesian, Vector > >;
+
+// Read access and members of the result type, shared by all nodes.
+// The members only exist if the result type has them, and each call evaluates the node once.
+template<class E, class Result>
+class ExpressionMembers : public ExpressionBase
+{
+	constexpr const E & self () const { return static_cast<const E &>(*this); }
+	public :
+	using result_type = Result;
+	constexpr Result eval () const { return Result( self() ); }
+
+	constexpr double operator [] ( size_t i ) const { return self()(i); }
+	constexpr double x () const { return self()(0); };
+	constexpr double y () const { return self()(1); };
+	constexpr double z () const { return self()(2); };
+
+	template<class T = Result> constexpr auto major () const -> decltype( std::declval<T>().major() ) { return eval().major(); }
+	template<class T = Result> constexpr auto minor () const -> decltype( std::declval<T>().minor() ) { return eval().minor(); }
+
+	// Vector
+	template<class T = Result> constexpr auto norm () const -> decltype( std::declval<T>().norm() ) { return eval().norm(); }
+	template<class T = Result> constexpr auto length () const -> decltype( std::declval<T>().length() ) { return eval().length(); }
+	template<class T = Result> constexpr auto normalised () const -> decltype( std::declval<T>().normalised() ) { return eval().normalised(); }
+	template<class A, class T = Result> constexpr auto cross ( const A & a ) const -> decltype( std::declval<T>().cross(a) ) { return eval().cross(a); }
+	template<class A, class T = Result> constexpr auto dot ( const A & a ) const -> decltype( std::declval<T>().dot(a) ) { return eval().dot(a); }
+	template<class A, class T = Result> constexpr auto angle ( const A & a ) const -> decltype( std::declval<T>().angle(a) ) { return eval().angle(a); }
+	template<class A, class T = Result> constexpr auto operator <  ( const A & a ) const -> decltype( std::declval<T>() <  a ) { return eval() <  a; }
+	template<class A, class T = Result> constexpr auto operator >  ( const A & a ) const -> decltype( std::declval<T>() >  a ) { return eval() >  a; }
+	template<class A, class T = Result> constexpr auto operator <= ( const A & a ) const -> decltype( std::declval<T>() <= a ) { return eval() <= a; }
+	template<class A, class T = Result> constexpr auto operator >= ( const A & a ) const -> decltype( std::declval<T>() >= a ) { return eval() >= a; }
+
+	// Point
+	template<class A, class T = Result> constexpr auto all_l  ( const A & a ) const -> decltype( std::declval<T>().all_l(a) ) { return eval().all_l(a); }
+	template<class A, class T = Result> constexpr auto all_le ( const A & a ) const -> decltype( std::declval<T>().all_le(a) ) { return eval().all_le(a); }
+	template<class A, class T = Result> constexpr auto all_g  ( const A & a ) const -> decltype( std::declval<T>().all_g(a) ) { return eval().all_g(a); }
+	template<class A, class T = Result> constexpr auto all_ge ( const A & a ) const -> decltype( std::declval<T>().all_ge(a) ) { return eval().all_ge(a); }
+	template<class T = Result> constexpr auto empty () const -> decltype( std::declval<T>().empty() ) { return eval().empty(); }
+};
+
+template<class Op, class L, class R, class Result>
+class BinaryExpression : public ExpressionMembers< BinaryExpression<Op,L,R,Result>, Result >
+{
+	L _l;
+	R _r;
+	public :
+	constexpr BinaryExpression ( L l, R r ) : _l(l), _r(r) {};
+	constexpr double operator () ( size_t i ) const { return Op::apply( component(_l,i), component(_r,i) ); }
+};
+
+template<class Op, class E, class Result>
+class UnaryExpression : public ExpressionMembers< UnaryExpression<Op,E,Result>, Result >
+{
+	E _e;
+	public :
+	constexpr UnaryExpression ( E e ) : _e(e) {};
+	constexpr double operator () ( size_t i ) const { return Op::apply( component(_e,i) ); }
+};
+
+template<class Op, class L, class R>
+constexpr BinaryExpression< Op, operand_t<L>, operand_t<R>, result_t<L,R> >
+make_expression ( L && l, R && r )
+{
+	return BinaryExpression< Op, operand_t<L>, operand_t<R>, result_t<L,R> > ( std::forward<L>(l), std::forward<R>(r) );
+}
+
+// Binary elementwise arithmetic
+template<class L, class R, typename = std::enable_if_t<is_operand_pair_v<L,R>>>
+constexpr auto operator + ( L && l, R && r ) { return make_expression<Add>( std::forward<L>(l), std::forward<R>(r) ); }
+template<class L, class R, typename = std::enable_if_t<is_operand_pair_v<L,R>>>
+constexpr auto operator - ( L && l, R && r ) { return make_expression<Sub>( std::forward<L>(l), std::forward<R>(r) ); }
+template<class L, class R, typename = std::enable_if_t<is_operand_pair_v<L,R>>>
+constexpr auto operator * ( L && l, R && r ) { return make_expression<Mul>( std::forward<L>(l), std::forward<R>(r) ); }
+template<class L, class R, typename = std::enable_if_t<is_operand_pair_v<L,R>>>
+constexpr auto operator / ( L && l, R && r ) { return make_expression<Div>( std::forward<L>(l), std::forward<R>(r) ); }
+
+// Unary negation of an expression (Cartesian types have their own)
+template<class E, typename = std::enable_if_t<is_expression_v<E>>>
+constexpr auto operator - ( E && e ) { return UnaryExpression< Neg, operand_t<E>, evaluated_t<E> > ( std::forward<E>(e) ); }
+
+// Returns the elementwise smallest value
+template<class L, class R, typename = std::enable_if_t<is_operand_v<L> && is_operand_v<R>>>
+constexpr auto emin ( L && l, R && r ) { return make_expression<Min>( std::forward<L>(l), std::forward<R>(r) ); }
+// Returns the elementwise largest value
+template<class L, class R, typename = std::enable_if_t<is_operand_v<L> && is_operand_v<R>>>
+constexpr auto emax ( L && l, R && r ) { return make_expression<Max>( std::forward<L>(l), std::forward<R>(r) ); }
+
+// Print an unevaluated expression the same way as a Point or Vector
+template<class E, typename = std::enable_if_t<is_expression_v<E>>>
+std::ostream & operator << ( std::ostream & out, const E & e ) { return out << e(0) << "," << e(1) << "," << e(2) << ";"; }
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef EUCLID_GEOMETRY_GRID
+#define EUCLID_GEOMETRY_GRID
+
+// Uniform grid over a run-time set of triangles, an alternative to Hierarchy for dense,
+// evenly tessellated meshes such as terrain or marching cubes output, where the cost of
+// descending a tree dominates. Queries have the same interface as Hierarchy.
+// Each cell lists the triangles whose bounding box (Triangle::pmin, pmax) overlaps it,
+// stored compactly as one offset array and one reference array (CSR). The build is a
+// counting sort run on several threads: count references per cell, prefix sum, scatter.
+// References within a cell are then sorted, so the result does not depend on threading.
+// Rays walk the cells by 3D-DDA, point queries search shells of cells of growing radius.
+// Both remember recently tested triangles in a small hashed mailbox on the stack, so a
+// triangle listed in several cells is rarely tested twice, and neither allocates.
+// Triangle indices and offsets are 32 bit, a mesh needing more references throws
+// std::length_error. Storage comes from a std::pmr::memory_resource, as for Hierarchy.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Ray.hpp"
+#include "Box.hpp"
+#include "Parallel.hpp"
+
+namespace Euclid {
+
+class Grid {
+	public :
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+	// density is the target number of cells per triangle
+	Grid ( const Triangle *, size_t, double density = 2., size_t threads = std::thread::hardware_concurrency(), allocator_type = {} );
+	Grid ( const std::vector<Triangle> & T, double density = 2., size_t threads = std::thread::hardware_concurrency(), allocator_type alloc = {} )
+	: Grid(T.data(),T.size(),density,threads,alloc) {};
+
+	// Data access
+	const Triangle & 	triangle	( size_t i ) const { return _triangles[i]; }
+	const Box & 		box			( ) const { return _box; }
+	size_t 				size		( ) const { return _triangles.size(); }
+	size_t 				cells		( ) const { return _dim[0]*_dim[1]*_dim[2]; }
+	size_t 				dim			( size_t i ) const { assert(i<3); return _dim[i]; }
+	size_t 				references	( ) const { return _refs.size(); }
+	allocator_type 		get_allocator ( ) const { return _refs.get_allocator(); }
+
+	// Queries
+	size_t 	closest_triangle	( const Point & ) const;
+	Point 	closest_point		( const Point & ) const;
+	bool 	distance			( const Point & , double&, double&) const;
+	bool 	intersect			( const Ray &, double & ) const;
+	bool 	intersect			( const Point &, const Vector &, double & ) const;
+
+	private :
+	std::pmr::vector<Triangle> 	_triangles;
+	std::pmr::vector<uint32_t> 	_offsets; // Cell c lists _refs[_offsets[c]] to _refs[_offsets[c+1]]
+	std::pmr::vector<uint32_t> 	_refs;
+	Box 						_box;
+	std::array<size_t,3> 		_dim;
+	Vector 						_cell; // Cell side lengths
+	Vector 						_inv; // Inverse cell side lengths
+
+	// Recently tested triangles, direct mapped on the triangle index
+	struct Mailbox {
+		std::array<uint32_t,64> slot;
+		Mailbox () { slot.fill(UINT32_MAX); }
+		bool seen ( uint32_t t ) { uint32_t & s = slot[t & 63]; if ( s == t ) return true; s = t; return false; }
+	};
+
+	size_t 	coordinate	( double, size_t ) const;
+	size_t 	index		( size_t i, size_t j, size_t k ) const { return i + _dim[0]*( j + _dim[1]*k ); }
+};
+
+// Cell coordinate along axis a, clamped to the grid
+inline size_t
+Grid::coordinate ( double x, size_t a ) const
+{
+	double c { ( x - _box.min()(a) ) * _inv(a) };
+	if ( !(c > 0.) ) return 0;
+	return std::min( size_t(c), _dim[a]-1 );
+};
+
+inline
+Grid::Grid ( const Triangle * T, size_t N, double density, size_t threads, allocator_type alloc )
+: _triangles(T,T+N,alloc), _offsets(alloc), _refs(alloc)
+{
+	assert( N > 0 );
+	if ( N >= UINT32_MAX ) throw std::length_error( "Grid: more triangles than 32 bit indices" );
+
+	// Bounds, padded so that no side is shorter than Box::min_side_length
+	Point pmin(+DBL_MAX,+DBL_MAX,+DBL_MAX);
+	Point pmax(-DBL_MAX,-DBL_MAX,-DBL_MAX);
+	for ( const Triangle & t : _triangles ) {
+		pmin = emin( t.pmin(), pmin );
+		pmax = emax( t.pmax(), pmax );
+	}
+	pmin -= 0.5*Box::min_side_length;
+	pmax += 0.5*Box::min_side_length;
+	_box = Box(pmin,pmax);
+
+	// Resolution: about density*N cubic cells. Thin sides are counted as at least
+	// a hundredth of the longest side, so flat meshes do not get a huge number of cells.
+	Vector S = pmax - pmin;
+	Vector E = emax( S, Vector( 1e-2*S.major() ) );
+	double k { cbrt( density * double(N) / ( E.x()*E.y()*E.z() ) ) };
+	for ( size_t a = 0; a < 3; ++a ) {
+		_dim[a] = std::max<size_t>( 1, std::min<size_t>( size_t( ceil( S(a) * k ) ), 1<<16 ) );
+		_cell.set( a, S(a) / double(_dim[a]) );
+		_inv.set( a, double(_dim[a]) / S(a) );
+	}
+	const size_t C { cells() };
+
+	// Count references per cell
+	std::pmr::vector<std::atomic<uint32_t>> count( C, alloc );
+	auto range = [&]( const Triangle & t, std::array<size_t,3> & lo, std::array<size_t,3> & hi ) {
+		const Point a { t.pmin() }, b { t.pmax() };
+		for ( size_t d = 0; d < 3; ++d ) { lo[d] = coordinate( a(d), d ); hi[d] = coordinate( b(d), d ); }
+	};
+	parallel_for( N, threads, 4096, [&]( size_t begin, size_t end ) {
+		std::array<size_t,3> lo, hi;
+		for ( size_t t = begin; t < end; ++t ) {
+			range( _triangles[t], lo, hi );
+			for ( size_t z = lo[2]; z <= hi[2]; ++z )
+			for ( size_t y = lo[1]; y <= hi[1]; ++y )
+			for ( size_t x = lo[0]; x <= hi[0]; ++x )
+				count[index(x,y,z)].fetch_add( 1, std::memory_order_relaxed );
+		}
+	} );
+
+	// Exclusive prefix sum, the counters become scatter cursors
+	_offsets.resize( C+1 );
+	uint64_t sum { 0 };
+	for ( size_t c = 0; c < C; ++c ) {
+		_offsets[c] = uint32_t(sum);
+		sum += count[c].load( std::memory_order_relaxed );
+		if ( sum >= UINT32_MAX ) throw std::length_error( "Grid: more cell references than 32 bit offsets" );
+		count[c].store( _offsets[c], std::memory_order_relaxed );
+	}
+	_offsets[C] = uint32_t(sum);
+	_refs.resize( sum );
+
+	// Scatter
+	parallel_for( N, threads, 4096, [&]( size_t begin, size_t end ) {
+		std::array<size_t,3> lo, hi;
+		for ( size_t t = begin; t < end; ++t ) {
+			range( _triangles[t], lo, hi );
+			for ( size_t z = lo[2]; z <= hi[2]; ++z )
+			for ( size_t y = lo[1]; y <= hi[1]; ++y )
+			for ( size_t x = lo[0]; x <= hi[0]; ++x )
+				_refs[ count[index(x,y,z)].fetch_add( 1, std::memory_order_relaxed ) ] = uint32_t(t);
+		}
+	} );
+
+	// Make the order within each cell independent of thread scheduling
+	parallel_for( C, threads, 4096, [&]( size_t begin, size_t end ) {
+		for ( size_t c = begin; c < end; ++c ) std::sort( _refs.begin()+_offsets[c], _refs.begin()+_offsets[c+1] );
+	} );
+};
+
+inline size_t
+Grid::closest_triangle ( const Point & p ) const
+{
+	// Search shells of cells around the cell nearest to p, Chebyshev radius r = 0,1,2,...
+	// Any triangle not yet tested has its closest point in a cell outside the searched
+	// block, so its distance is at least the distance from p to the block boundary.
+	const size_t c[3] { coordinate(p.x(),0), coordinate(p.y(),1), coordinate(p.z(),2) };
+	const size_t rmax { std::max( std::max(_dim[0],_dim[1]), _dim[2] ) };
+	Mailbox mailbox;
+	double best_sq { DBL_MAX };
+	size_t best { 0 };
+	for ( size_t r = 0; r < rmax; ++r ) {
+		size_t lo[3], hi[3];
+		for ( size_t a = 0; a < 3; ++a ) { lo[a] = c[a] > r ? c[a]-r : 0; hi[a] = std::min( c[a]+r, _dim[a]-1 ); }
+		auto visit = [&]( size_t x, size_t y, size_t z ) {
+			const size_t cell { index(x,y,z) };
+			for ( uint32_t k = _offsets[cell]; k < _offsets[cell+1]; ++k ) {
+				const uint32_t t { _refs[k] };
+				if ( mailbox.seen(t) ) continue;
+				double sq_dist { Vector( p , _triangles[t].closest_point(p) ).norm() };
+				if ( sq_dist < best_sq ) { best_sq = sq_dist; best = t; }
+			}
+		};
+		// Only the shell, the inner cells were searched on previous radii
+		for ( size_t z = lo[2]; z <= hi[2]; ++z )
+		for ( size_t y = lo[1]; y <= hi[1]; ++y ) {
+			if ( z+r == c[2] || z == c[2]+r || y+r == c[1] || y == c[1]+r ) {
+				for ( size_t x = lo[0]; x <= hi[0]; ++x ) visit(x,y,z);
+				continue;
+			}
+			if ( c[0] >= r ) visit(c[0]-r,y,z);
+			if ( c[0]+r < _dim[0] ) visit(c[0]+r,y,z);
+		}
+		// Lower bound on the distance to cells outside the block
+		double bound { DBL_MAX };
+		for ( size_t a = 0; a < 3; ++a ) {
+			if ( lo[a] > 0 ) 		 bound = std::min( bound, std::max( 0., p(a) - ( _box.min()(a) + double(lo[a])*_cell(a) ) ) );
+			if ( hi[a] < _dim[a]-1 ) bound = std::min( bound, std::max( 0., _box.min()(a) + double(hi[a]+1)*_cell(a) - p(a) ) );
+		}
+		if ( bound == DBL_MAX || best_sq <= bound*bound ) break;
+	}
+	return best;
+};
+
+inline Point
+Grid::closest_point ( const Point & p ) const
+{
+	return _triangles[closest_triangle(p)].closest_point(p);
+};
+
+inline bool
+Grid::distance ( const Point & p , double&sq_dist, double&sign) const
+{
+	return _triangles[closest_triangle(p)].distance(p,sq_dist,sign);
+};
+
+inline bool
+Grid::intersect ( const Ray & r, double & t ) const
+{
+	return intersect(r.origin(),r.direction(),t);
+};
+
+inline bool
+Grid::intersect ( const Point & src, const Vector & dir, double & t ) const
+{
+	// Clip the ray against the grid bounds
+	double t0 { 0. }, t1 { DBL_MAX };
+	for ( size_t a = 0; a < 3; ++a ) {
+		if ( dir(a) == 0. ) {
+			if ( src(a) < _box.min()(a) || src(a) > _box.max()(a) ) return false;
+			continue;
+		}
+		double ta { ( _box.min()(a) - src(a) ) / dir(a) };
+		double tb { ( _box.max()(a) - src(a) ) / dir(a) };
+		t0 = std::max( t0, std::min(ta,tb) );
+		t1 = std::min( t1, std::max(ta,tb) );
+	}
+	if ( t0 > t1 ) return false;
+
+	// 3D-DDA from the entry cell
+	const Point entry { src + dir * t0 };
+	size_t c[3];
+	long step[3];
+	double next[3], delta[3];
+	for ( size_t a = 0; a < 3; ++a ) {
+		c[a] = coordinate( entry(a), a );
+		if ( dir(a) > 0. ) {
+			step[a] = 1;
+			next[a] = ( _box.min()(a) + double(c[a]+1)*_cell(a) - src(a) ) / dir(a);
+			delta[a] = _cell(a) / dir(a);
+		} else if ( dir(a) < 0. ) {
+			step[a] = -1;
+			next[a] = ( _box.min()(a) + double(c[a])*_cell(a) - src(a) ) / dir(a);
+			delta[a] = -_cell(a) / dir(a);
+		} else {
+			step[a] = 0;
+			next[a] = DBL_MAX;
+			delta[a] = DBL_MAX;
+		}
+	}
+
+	Mailbox mailbox;
+	bool hit { false };
+	while ( true ) {
+		const size_t cell { index(c[0],c[1],c[2]) };
+		for ( uint32_t k = _offsets[cell]; k < _offsets[cell+1]; ++k ) {
+			const uint32_t i { _refs[k] };
+			if ( mailbox.seen(i) ) continue;
+			double s { 0. };
+			if ( _triangles[i].intersect(src,dir,s) && s >= 0 && ( !hit || s < t ) ) { t = s; hit = true; }
+		}
+		// Advance along the axis whose cell boundary is nearest
+		const size_t a = next[0] < next[1] ? ( next[0] < next[2] ? 0 : 2 ) : ( next[1] < next[2] ? 1 : 2 );
+		// A hit before the exit of this cell cannot be beaten by later cells
+		if ( hit && t <= next[a] ) return true;
+		if ( next[a] > t1 ) return hit;
+		if ( step[a] < 0 ? c[a] == 0 : c[a] == _dim[a]-1 ) return hit;
+		c[a] += step[a];
+		next[a] += delta[a];
+	}
+};
+
+} // namespace Euclid
+
+#endif
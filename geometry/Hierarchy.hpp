@@ -0,0 +1,107 @@
+#ifndef EUCLID_GEOMETRY_HIERARCHY
+#define EUCLID_GEOMETRY_HIERARCHY
+
+// Bounding box hierarchy over a run-time set of triangles.
+// All storage comes from a std::pmr::memory_resource, the default resource unless one
+// is given. A build makes exactly five allocations (triangles and nodes, plus the index,
+// triangle box and triangle centre scratch used for in-place partitioning), queries make
+// none: their traversal stack is a fixed-size array, which the depth limit of the build
+// guarantees is large enough.
+// With a std::pmr::monotonic_buffer_resource per request, everything is released in O(1)
+// when the resource goes out of scope.
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Ray.hpp"
+#include "Box.hpp"
+#include "Traversal.hpp"
+
+namespace Euclid {
+
+class Hierarchy {
+	public :
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+	using Node = HierarchyNode;
+	using Stack = std::array<size_t,64>;
+	constexpr static size_t max_depth { 63 }; // One less than the stack size
+
+	Hierarchy ( const Triangle *, size_t, allocator_type = {} );
+	Hierarchy ( const std::vector<Triangle> & T, allocator_type alloc = {} ) : Hierarchy(T.data(),T.size(),alloc) {};
+
+	// Data access
+	const Node & 		node		( size_t i ) const { return _nodes[i]; }
+	const Triangle & 	triangle	( size_t i ) const { return _triangles[i]; }
+	const Box & 		box			( ) const { return _nodes[0].box; }
+	size_t 				size		( ) const { return _triangles.size(); }
+	allocator_type 		get_allocator ( ) const { return _nodes.get_allocator(); }
+
+	// Queries
+	size_t 	closest_triangle	( const Point & ) const;
+	Point 	closest_point		( const Point & ) const;
+	bool 	distance			( const Point & , double&, double&) const;
+	bool 	intersect			( const Ray &, double & ) const;
+	bool 	intersect			( const Point &, const Vector &, double & ) const;
+
+	private :
+	std::pmr::vector<Triangle> 	_triangles;
+	std::pmr::vector<Node> 		_nodes;
+};
+
+inline
+Hierarchy::Hierarchy ( const Triangle * T, size_t N, allocator_type alloc ) : _triangles(T,T+N,alloc), _nodes(alloc)
+{
+	assert( N > 0 );
+	_nodes.resize( 2*N-1 );
+	std::pmr::vector<size_t> index( N, alloc );
+	std::pmr::vector<Box> boxes( N, alloc );
+	std::pmr::vector<Point> centers( N, alloc );
+	for ( size_t i = 0; i < N; ++i ) {
+		index[i] = i;
+		boxes[i] = Box::box( _triangles[i] );
+		centers[i] = _triangles[i].center();
+	}
+	size_t next { 0 };
+	build_hierarchy( boxes.data(), centers.data(), _nodes, index.data(), index.data()+N, next, max_depth );
+};
+
+inline size_t
+Hierarchy::closest_triangle ( const Point & p ) const
+{
+	Stack stack;
+	return Euclid::closest_triangle( _triangles, _nodes, p, stack );
+};
+
+inline Point
+Hierarchy::closest_point ( const Point & p ) const
+{
+	return _triangles[closest_triangle(p)].closest_point(p);
+};
+
+inline bool
+Hierarchy::distance ( const Point & p , double&sq_dist, double&sign) const
+{
+	return _triangles[closest_triangle(p)].distance(p,sq_dist,sign);
+};
+
+inline bool
+Hierarchy::intersect ( const Ray & r, double & t ) const
+{
+	return intersect(r.origin(),r.direction(),t);
+};
+
+inline bool
+Hierarchy::intersect ( const Point & src, const Vector & dir, double & t ) const
+{
+	Stack stack;
+	return Euclid::intersect( _triangles, _nodes, src, dir, t, stack );
+};
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef EUCLID_GEOMETRY_ORIENTEDBOX
+#define EUCLID_GEOMETRY_ORIENTEDBOX
+
+// Oriented bounding box: a centre, three orthonormal axes and the half side lengths
+// along them. Much tighter than Box around long, diagonal geometry such as pipes and beams.
+// Fitting is either by principal component analysis of the points, or approximately
+// minimum volume: the smallest of the PCA frame, the world frame and frames spanned by
+// a large triangle of extremal points (in the spirit of the DiTO method).
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Ray.hpp"
+
+namespace Euclid {
+
+class OrientedBox {
+	Point 					_centre;
+	std::array<Vector,3> 	_axes { Vector(1,0,0), Vector(0,1,0), Vector(0,0,1) };
+	Vector 					_half;
+	public :
+	constexpr OrientedBox() {}
+	constexpr OrientedBox( const Point & c, const std::array<Vector,3> & axes, const Vector & half ) : _centre(c), _axes(axes), _half(half) {}
+
+	// Fitting to a set of points
+	static OrientedBox 	fit			( const Point *, size_t, const std::array<Vector,3> & );
+	static OrientedBox 	fit_pca		( const Point *, size_t );
+	static OrientedBox 	fit			( const Point *, size_t );
+
+	// Data access
+	constexpr const Point & 	centre	( ) const { return _centre; }
+	constexpr const Vector & 	axis	( size_t i ) const { assert(i<3); return _axes[i]; }
+	constexpr const Vector & 	half	( ) const { return _half; }
+
+	// Properties
+	constexpr double 	volume			( ) const { return 8.*_half.x()*_half.y()*_half.z(); }
+	constexpr double 	surface_area	( ) const { return 8.*(_half.x()*_half.y()+_half.y()*_half.z()+_half.z()*_half.x()); }
+
+	// Exact squared distances from a point to the nearest and farthest point of the box,
+	// the limit of min_sq_dist is unused, it matches DOP which may stop early
+	constexpr void 		minmax_sq_dist	( const Point &, double&, double& ) const;
+	constexpr double 	min_sq_dist		( const Point &, double limit = DBL_MAX ) const;
+	// Whether the ray, ie. points src+t*dir with t >= 0, meets the box
+	constexpr bool 		intersect		( const Ray & ) const;
+	constexpr bool 		intersect		( const Point &, const Vector & ) const;
+};
+
+inline OrientedBox
+OrientedBox::fit( const Point * P, size_t N, const std::array<Vector,3> & axes )
+{
+	// Extents of the points along the given orthonormal frame
+	double lo[3] { +DBL_MAX, +DBL_MAX, +DBL_MAX };
+	double hi[3] { -DBL_MAX, -DBL_MAX, -DBL_MAX };
+	for ( size_t k = 0; k < N; ++k ) {
+		const Vector v { P[k] };
+		for ( size_t a = 0; a < 3; ++a ) {
+			double d { dot(v,axes[a]) };
+			lo[a] = std::min(lo[a],d);
+			hi[a] = std::max(hi[a],d);
+		}
+	}
+	Point c { axes[0]*(0.5*(lo[0]+hi[0])) + axes[1]*(0.5*(lo[1]+hi[1])) + axes[2]*(0.5*(lo[2]+hi[2])) };
+	return OrientedBox( c, axes, Vector( 0.5*(hi[0]-lo[0]), 0.5*(hi[1]-lo[1]), 0.5*(hi[2]-lo[2]) ) );
+};
+
+inline OrientedBox
+OrientedBox::fit_pca( const Point * P, size_t N )
+{
+	assert( N > 0 );
+	// Covariance of the points
+	Point m { 0. };
+	for ( size_t k = 0; k < N; ++k ) m += P[k];
+	m /= double(N);
+	double C[3][3] {};
+	for ( size_t k = 0; k < N; ++k ) {
+		const Vector d { m, P[k] };
+		for ( size_t i = 0; i < 3; ++i ) for ( size_t j = 0; j < 3; ++j ) C[i][j] += d(i)*d(j);
+	}
+
+	// Eigenvectors by cyclic Jacobi rotations, V holds them as columns
+	double V[3][3] { {1,0,0}, {0,1,0}, {0,0,1} };
+	for ( int sweep = 0; sweep < 16; ++sweep ) {
+		double off { C[0][1]*C[0][1] + C[0][2]*C[0][2] + C[1][2]*C[1][2] };
+		if ( off < 1e-30 * ( C[0][0]*C[0][0] + C[1][1]*C[1][1] + C[2][2]*C[2][2] ) ) break;
+		for ( size_t p = 0; p < 2; ++p ) for ( size_t q = p+1; q < 3; ++q ) {
+			if ( C[p][q] == 0. ) continue;
+			double theta { 0.5 * ( C[q][q] - C[p][p] ) / C[p][q] };
+			double t { ( theta >= 0 ? 1. : -1. ) / ( std::abs(theta) + sqrt( theta*theta + 1. ) ) };
+			double c { 1. / sqrt( t*t + 1. ) }, s { t*c };
+			for ( size_t k = 0; k < 3; ++k ) {
+				double a { C[k][p] }, b { C[k][q] };
+				C[k][p] = c*a - s*b; C[k][q] = s*a + c*b;
+			}
+			for ( size_t k = 0; k < 3; ++k ) {
+				double a { C[p][k] }, b { C[q][k] };
+				C[p][k] = c*a - s*b; C[q][k] = s*a + c*b;
+			}
+			for ( size_t k = 0; k < 3; ++k ) {
+				double a { V[k][p] }, b { V[k][q] };
+				V[k][p] = c*a - s*b; V[k][q] = s*a + c*b;
+			}
+		}
+	}
+	Vector e0 { Vector( V[0][0], V[1][0], V[2][0] ).normalised() };
+	Vector e1 { Vector( V[0][1], V[1][1], V[2][1] ) };
+	e1 = Vector( e1 - e0 * dot(e0,e1) ).normalised();
+	return fit( P, N, { e0, e1, cross(e0,e1) } );
+};
+
+inline OrientedBox
+OrientedBox::fit( const Point * P, size_t N )
+{
+	assert( N > 0 );
+	OrientedBox best { fit_pca( P, N ) };
+	auto consider = [&]( const OrientedBox & b ) { if ( b.volume() < best.volume() ) best = b; };
+	consider( fit( P, N, { Vector(1,0,0), Vector(0,1,0), Vector(0,0,1) } ) );
+
+	// Extremal points along the axes and the four cube diagonals
+	const Vector dirs[7] { Vector(1,0,0), Vector(0,1,0), Vector(0,0,1), Vector(1,1,1), Vector(1,1,-1), Vector(1,-1,1), Vector(1,-1,-1) };
+	size_t lo[7] {}, hi[7] {};
+	for ( size_t k = 1; k < N; ++k ) for ( size_t d = 0; d < 7; ++d ) {
+		if ( dot(Vector(P[k]),dirs[d]) < dot(Vector(P[lo[d]]),dirs[d]) ) lo[d] = k;
+		if ( dot(Vector(P[k]),dirs[d]) > dot(Vector(P[hi[d]]),dirs[d]) ) hi[d] = k;
+	}
+	// The farthest pair is the first edge of a large triangle, the extremal point
+	// farthest from that line the third vertex
+	size_t a { lo[0] }, b { hi[0] };
+	for ( size_t d = 1; d < 7; ++d ) if ( Vector(P[lo[d]],P[hi[d]]).norm() > Vector(P[a],P[b]).norm() ) { a = lo[d]; b = hi[d]; }
+	const Vector u { P[a], P[b] };
+	if ( u.norm() == 0. ) return best;
+	const Vector e0 { u.normalised() };
+	size_t c { a };
+	double far { 0. };
+	for ( size_t d = 0; d < 7; ++d ) for ( size_t k : { lo[d], hi[d] } ) {
+		const Vector w { P[a], P[k] };
+		double h { Vector( w - e0 * dot(w,e0) ).norm() };
+		if ( h > far ) { far = h; c = k; }
+	}
+	if ( far == 0. ) return best;
+	const Vector n { cross( u, Vector(P[a],P[c]) ).normalised() };
+	// One frame per triangle edge, each with the triangle normal as third axis
+	for ( const Vector & edge : { u, Vector(P[b],P[c]), Vector(P[c],P[a]) } ) {
+		const Vector f0 { edge.normalised() };
+		consider( fit( P, N, { f0, cross(n,f0), n } ) );
+	}
+	return best;
+};
+
+constexpr void
+OrientedBox::minmax_sq_dist( const Point & p, double&min, double&max ) const
+{
+	// In the frame of the box, per axis: distance outside the slab, and distance to the far side
+	const Vector v { _centre, p };
+	min = 0.;
+	max = 0.;
+	for ( size_t a = 0; a < 3; ++a ) {
+		double q { dot(v,_axes[a]) };
+		q = q < 0 ? -q : q;
+		double d { q > _half(a) ? q - _half(a) : 0. };
+		min += d*d;
+		max += (q + _half(a))*(q + _half(a));
+	}
+};
+
+constexpr double
+OrientedBox::min_sq_dist( const Point & p, double ) const
+{
+	double min { 0. }, max { 0. };
+	minmax_sq_dist( p, min, max );
+	return min;
+};
+
+constexpr bool
+OrientedBox::intersect( const Ray & r ) const
+{
+	return intersect( r.origin(), r.direction() );
+};
+
+constexpr bool
+OrientedBox::intersect( const Point & src, const Vector & dir ) const
+{
+	// Slab test in the frame of the box
+	const double tiny { 3e-7 };
+	const Vector v { _centre, src };
+	double tmin { 0. }, tmax { DBL_MAX };
+	for ( size_t a = 0; a < 3; ++a ) {
+		double o { dot(v,_axes[a]) };
+		double d { dot(dir,_axes[a]) };
+		if ( d == 0. ) {
+			if ( o < -_half(a)-tiny || o > _half(a)+tiny ) return false;
+			continue;
+		}
+		double t0 { (-_half(a)-o) / d }, t1 { (_half(a)-o) / d };
+		if ( t0 > t1 ) { double t { t0 }; t0 = t1; t1 = t; }
+		tmin = std::max(tmin,t0);
+		tmax = std::min(tmax,t1);
+	}
+	return ( (tmin-tiny) < (tmax+tiny) );
+};
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef EUCLID_GEOMETRY_PARALLEL
+#define EUCLID_GEOMETRY_PARALLEL
+
+// Splitting a range of independent work items over threads, and prefetching, for the
+// batch queries
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace Euclid {
+
+// Run f(begin,end) over the range [0,n) split into chunks, one per thread, using no
+// more threads than leaves each at least grain items
+template<class F>
+void
+parallel_for ( size_t n, size_t threads, size_t grain, const F & f )
+{
+	threads = std::max<size_t>( 1, std::min( threads, n/std::max<size_t>(grain,1) ) );
+	if ( threads == 1 ) { f(0,n); return; }
+	std::vector<std::thread> pool;
+	pool.reserve( threads );
+	for ( size_t t = 0; t < threads; ++t ) pool.emplace_back( f, n*t/threads, n*(t+1)/threads );
+	for ( std::thread & t : pool ) t.join();
+}
+
+// Hint that memory will be read soon, a no-op where the builtin is unavailable
+inline void
+prefetch ( const void * p )
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch( p, 0, 3 );
+#else
+	(void)p;
+#endif
+}
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef EUCLID_GEOMETRY_PIPELINE
+#define EUCLID_GEOMETRY_PIPELINE
+
+// Batch queries on a hierarchy, with memory latency hidden by interleaving queries.
+// A traversal is a chain of dependent loads, node after node, and on trees larger than
+// the cache nearly every one is a miss. Here each thread keeps N queries in flight as
+// small state machines, lanes, and advances them round robin one step at a time. A step
+// only reads memory that was prefetched when the lane last ran, so while one lane waits
+// for its next node the other N-1 work, and the misses of different queries overlap.
+// A closest point step pops a node, expands it once its children are in cache, or tests a
+// leaf once its triangle is; a ray step tests a node, prefetched when it was pushed.
+// Results are the same as those of the hierarchy's own queries.
+// Works with any hierarchy exposing node(i) and triangle(i) by reference and a Stack
+// type deep enough for its tree, ie. Hierarchy and StaticHierarchy. Lanes live on the
+// call stack and no query allocates, except for the threads when more than one is asked.
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cstddef>
+#include <tuple>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Traversal.hpp"
+#include "Parallel.hpp"
+
+namespace Euclid {
+
+template<class H, size_t N = 8>
+class Pipeline {
+	public :
+	Pipeline ( const H & h ) : _h(h) {};
+
+	// Queries on a batch of count points or rays, split over threads. For rays t is only
+	// assigned where hit is true.
+	void 	closest_triangle	( const Point *, size_t count, size_t *, size_t threads = 1 ) const;
+	void 	closest_point		( const Point *, size_t count, Point *, size_t threads = 1 ) const;
+	void 	intersect			( const Point *, const Vector *, size_t count, double *, bool *, size_t threads = 1 ) const;
+
+	private :
+	constexpr static size_t depth { std::tuple_size<typename H::Stack>::value };
+	enum class Step { Done, Pop, Expand, Leaf };
+	struct Lane {
+		Step 						step { Step::Done };
+		size_t 						query { 0 };
+		size_t 						node { 0 }; // Node to expand or leaf to test
+		size_t 						top { 0 };
+		typename H::Stack 			stack {};
+		std::array<double,depth> 	bound {}; // Squared min distance of each node on the stack
+		double 						best_sq { DBL_MAX };
+		size_t 						best { 0 };
+		double 						t { 0. };
+		bool 						hit { false };
+	};
+	const H & _h;
+
+	void 	nearest 	( const Point *, size_t, size_t, size_t * ) const;
+	void 	rays 		( const Point *, const Vector *, size_t, size_t, double *, bool * ) const;
+};
+
+template<class H, size_t N>
+void
+Pipeline<H,N>::closest_triangle ( const Point * P, size_t count, size_t * index, size_t threads ) const
+{
+	parallel_for( count, threads, 4*N, [&]( size_t begin, size_t end ) { nearest( P, begin, end, index ); } );
+};
+
+template<class H, size_t N>
+void
+Pipeline<H,N>::closest_point ( const Point * P, size_t count, Point * closest, size_t threads ) const
+{
+	parallel_for( count, threads, 4*N, [&]( size_t begin, size_t end ) {
+		// Triangle indices first, a bounded batch at a time in a buffer on the stack
+		constexpr size_t batch { 1024 };
+		std::array<size_t,batch> index;
+		for ( size_t b = begin; b < end; b += batch ) {
+			const size_t e { std::min( end, b+batch ) };
+			nearest( P+b, 0, e-b, index.data() );
+			for ( size_t q = b; q < e; ++q ) closest[q] = _h.triangle(index[q-b]).closest_point(P[q]);
+		}
+	} );
+};
+
+template<class H, size_t N>
+void
+Pipeline<H,N>::intersect ( const Point * src, const Vector * dir, size_t count, double * t, bool * hit, size_t threads ) const
+{
+	parallel_for( count, threads, 4*N, [&]( size_t begin, size_t end ) { rays( src, dir, begin, end, t, hit ); } );
+};
+
+template<class H, size_t N>
+void
+Pipeline<H,N>::nearest ( const Point * P, size_t begin, size_t end, size_t * index ) const
+{
+	// The same branch and bound as closest_triangle in Traversal.hpp, split into steps
+	std::array<Lane,N> lanes;
+	size_t next { begin }, active { 0 };
+	auto start = [&]( Lane & l ) {
+		if ( next == end ) { l.step = Step::Done; return; }
+		l.query = next++;
+		l.top = 0;
+		l.stack[l.top] = 0;
+		l.bound[l.top++] = 0.;
+		l.best_sq = DBL_MAX;
+		l.best = 0;
+		l.step = Step::Pop;
+		++active;
+	};
+	prefetch( &_h.node(0) );
+	for ( Lane & l : lanes ) start(l);
+	while ( active > 0 ) {
+		for ( Lane & l : lanes ) {
+			switch ( l.step ) {
+				case Step::Done : break;
+				case Step::Pop : {
+					// Drop nodes that the best so far already rules out
+					while ( l.top > 0 && l.bound[l.top-1] > l.best_sq ) --l.top;
+					if ( l.top == 0 ) { index[l.query] = l.best; --active; start(l); break; }
+					l.node = l.stack[--l.top];
+					// In cache since its parent was expanded
+					const HierarchyNode & node = _h.node(l.node);
+					if ( node.leaf() ) { prefetch( &_h.triangle(node.triangle) ); l.step = Step::Leaf; }
+					else { prefetch( &_h.node(l.node+1) ); prefetch( &_h.node(node.right) ); l.step = Step::Expand; }
+					break;
+				}
+				case Step::Expand : {
+					const Point & p = P[l.query];
+					const size_t left { l.node + 1 };
+					const size_t right { _h.node(l.node).right };
+					const double lmin { BoxBounds().min_sq_dist( _h.node(left), left, p, l.best_sq ) };
+					const double rmin { BoxBounds().min_sq_dist( _h.node(right), right, p, l.best_sq ) };
+					// Farthest first so the nearest is popped first
+					if ( lmin < rmin ) { l.stack[l.top] = right; l.bound[l.top++] = rmin; l.stack[l.top] = left; l.bound[l.top++] = lmin; }
+					else 			   { l.stack[l.top] = left; l.bound[l.top++] = lmin; l.stack[l.top] = right; l.bound[l.top++] = rmin; }
+					l.step = Step::Pop;
+					break;
+				}
+				case Step::Leaf : {
+					const Point & p = P[l.query];
+					const size_t t { _h.node(l.node).triangle };
+					const double sq_dist { Vector( p, _h.triangle(t).closest_point(p) ).norm() };
+					if ( sq_dist < l.best_sq ) { l.best_sq = sq_dist; l.best = t; }
+					l.step = Step::Pop;
+					break;
+				}
+			}
+		}
+	}
+};
+
+template<class H, size_t N>
+void
+Pipeline<H,N>::rays ( const Point * src, const Vector * dir, size_t begin, size_t end, double * t, bool * hit ) const
+{
+	// The same traversal as intersect in Traversal.hpp, split into steps
+	std::array<Lane,N> lanes;
+	size_t next { begin }, active { 0 };
+	auto start = [&]( Lane & l ) {
+		if ( next == end ) { l.step = Step::Done; return; }
+		l.query = next++;
+		l.top = 0;
+		l.stack[l.top++] = 0;
+		l.hit = false;
+		l.step = Step::Pop;
+		++active;
+	};
+	prefetch( &_h.node(0) );
+	for ( Lane & l : lanes ) start(l);
+	while ( active > 0 ) {
+		for ( Lane & l : lanes ) {
+			const size_t q { l.query };
+			switch ( l.step ) {
+				case Step::Done : break;
+				case Step::Pop : {
+					if ( l.top == 0 ) {
+						hit[q] = l.hit;
+						if ( l.hit ) t[q] = l.t;
+						--active;
+						start(l);
+						break;
+					}
+					// Prefetched when pushed
+					l.node = l.stack[--l.top];
+					const HierarchyNode & node = _h.node(l.node);
+					if ( !node.box.intersect( src[q], dir[q] ) ) break;
+					if ( node.leaf() ) { prefetch( &_h.triangle(node.triangle) ); l.step = Step::Leaf; break; }
+					l.stack[l.top++] = node.right;
+					l.stack[l.top++] = l.node + 1;
+					prefetch( &_h.node(node.right) );
+					prefetch( &_h.node(l.node+1) );
+					break;
+				}
+				case Step::Expand : break;
+				case Step::Leaf : {
+					double s { 0. };
+					if ( _h.triangle(_h.node(l.node).triangle).intersect( src[q], dir[q], s ) && s >= 0 && ( !l.hit || s < l.t ) ) { l.t = s; l.hit = true; }
+					l.step = Step::Pop;
+					break;
+				}
+			}
+		}
+	}
+};
+
+} // namespace Euclid
+
+#endif
@@ -22,8 +22,10 @@ class Point : public Cartesian
 	constexpr Point	( const std::array<double,3> & A ) : Cartesian(A) {};
 	constexpr Point	( const std::array<float,3> & A ) : Cartesian(A) {};
 	constexpr Point	( const Point & P ) : Cartesian(P.x(),P.y(),P.z()) {};
+	template<class E, typename = std::enable_if_t<is_expression_v<E>>>
+	constexpr Point	( const E & e ) : Cartesian(e) {};
 
-	const Point & 		operator = 	( const Point & );
+	constexpr const Point & operator = 	( const Point & );
 
 	constexpr Point 		operator - 	() { return Point( -x(),-y(),-z() ); };
 
@@ -39,6 +41,11 @@ class Point : public Cartesian
 	const Point operator -= ( const double & a ) { Cartesian::operator -= ( a ); return *this; }; 
 	const Point operator *= ( const double & a ) { Cartesian::operator *= ( a ); return *this; };
 	const Point operator /= ( const double & a ) { Cartesian::operator /= ( a ); return *this; }; 
+	// Elementwise compound assignment from a Cartesian type or expression
+	using Cartesian::operator +=;
+	using Cartesian::operator -=;
+	using Cartesian::operator *=;
+	using Cartesian::operator /=;
 
 	constexpr bool all_l  (const Point &) const;
 	constexpr bool all_le (const Point &) const;
@@ -49,7 +56,7 @@ class Point : public Cartesian
 	constexpr bool empty() const;
 
 	friend std::ostream & operator << ( std::ostream & out, const Point A ) { return out << A.x() << "," << A.y() << "," << A.z() << ";"; };
-	friend std::ostream & operator << ( std::ostream & out, const std::vector<Point> v ) { for ( Point c : v ) out << "\n\t" << c; out << std::endl; return out; };
+	friend std::ostream & operator << ( std::ostream & out, const std::vector<Point> & v ) { for ( const Point & c : v ) out << "\n\t" << c; out << std::endl; return out; };
 
 
 }; // class Point
@@ -66,7 +73,7 @@ const Point & 	Point::operator /= ( const double & a ) { data[0] /= a; data[1] /
 const Point & 	Point::operator += ( const Point & P ) { return Cartesian::operator +=(P); }
 const Point & 	Point::operator -= ( const Point & P ) { data[0] -= P.x(); data[1] -= P.y(); data[2] -= P.z(); return *this; }
 */
-const Point & 	Point::operator =  ( const Point & P ) { data[0] =  P.x(); data[1] =  P.y(); data[2] =  P.z(); return *this; }
+constexpr const Point & Point::operator =  ( const Point & P ) { data[0] =  P.x(); data[1] =  P.y(); data[2] =  P.z(); return *this; }
 
 // Comparison from class
 constexpr bool Point::all_l  (const Point & p) const { return (x() <  p.x() && y() <  p.y() && z() <  p.z() ); }
@@ -84,40 +91,12 @@ inline constexpr bool 	operator != ( const Point & A, const Point & B ) { return
 inline constexpr Point 	operator + 	( const Point & P ) { return P; }
 inline constexpr Point 	operator - 	( const Point & P ) { return Point( -P.x(),-P.y(),-P.z() ); }
 
-// Arithmetic
-inline constexpr Point operator + ( const Point  & A, const Point  & B) { return Point(A.x()+B.x(),A.y()+B.y(),A.z()+B.z()); }
-inline constexpr Point operator + ( const Point  & A, const double & b) { return Point(A.x()+b,A.y()+b,A.z()+b); }
-inline constexpr Point operator + ( const double & a, const Point  & B) { return Point(B.x()+a,B.y()+a,B.z()+a); }
-
-inline constexpr Point operator - ( const Point  & A, const Point  & B) { return Point(A.x()-B.x(),A.y()-B.y(),A.z()-B.z()); }
-inline constexpr Point operator - ( const Point  & A, const double & b) { return Point(A.x()-b,A.y()-b,A.z()-b); }
-inline constexpr Point operator - ( const double & a, const Point  & B) { return Point(B.x()-a,B.y()-a,B.z()-a); }
-
-inline constexpr Point operator * ( const Point  & A, const double & b) { return Point(A.x()*b,A.y()*b,A.z()*b); }
-inline constexpr Point operator * ( const double & a, const Point  & B) { return Point(B.x()*a,B.y()*a,B.z()*a); }
-
-inline constexpr Point operator / ( const Point  & A, const double & b) { return Point(A.x()/b,A.y()/b,A.z()/b); }
-
+// Binary arithmetic, emin and emax are lazy, see Expression.hpp
 
 // Argument, angle, with respect to axes in cartesian coordinate system
 std::array<double,3> 	arg ( const Point & ); // angle to axes
 double 					arg ( const Point & , int plane ); // angle above specified plane
 
-// Returns the elementwise smallest value
-inline constexpr Point
-emin ( const Point & v1 , const Point & v2 )
-{
-	using std::min;
-	return Point {min(v1.x(),v2.x()),min(v1.y(),v2.y()),min(v1.z(),v2.z())};
-}
-// Returns the elementwise largest value
-inline constexpr Point
-emax ( const Point & v1 , const Point & v2 )
-{
-	using std::max;
-	return Point {max(v1.x(),v2.x()),max(v1.y(),v2.y()),max(v1.z(),v2.z())};
-}
-
 } // namespace Euclid
 
 #endif
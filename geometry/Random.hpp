@@ -0,0 +1,56 @@
+#ifndef EUCLID_GEOMETRY_RANDOM
+#define EUCLID_GEOMETRY_RANDOM
+
+// Counter-based random numbers: Philox4x32-10 (Salmon et al., "Parallel random numbers:
+// as easy as 1, 2, 3", SC 2011). The numbers are a pure function of a key and a counter,
+// so any element of any stream can be computed directly, in any order and on any thread,
+// and results do not depend on how work is split. A key selects a stream, for instance
+// from a seed, and each counter value gives four independent 32 bit numbers.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Euclid {
+
+class Philox {
+	public :
+	using Counter = std::array<uint32_t,4>;
+	using Key = std::array<uint32_t,2>;
+
+	constexpr Philox ( uint64_t seed = 0 ) : _key({{ uint32_t(seed), uint32_t(seed >> 32) }}) {}
+
+	// Four numbers for counter c
+	constexpr Counter 	operator () ( Counter c ) const;
+	// Four numbers for the 64 bit index i of substream s
+	constexpr Counter 	operator () ( uint64_t i, uint32_t s = 0 ) const { return (*this)( Counter{{ uint32_t(i), uint32_t(i >> 32), s, 0 }} ); }
+
+	// A 32 bit number as a double in [0,1)
+	constexpr static double uniform ( uint32_t x ) { return double(x) * ( 1. / 4294967296. ); }
+
+	private :
+	Key _key;
+};
+
+constexpr Philox::Counter
+Philox::operator () ( Counter c ) const
+{
+	// Scalars rather than arrays, so that the rounds stay in registers
+	uint32_t c0 { c[0] }, c1 { c[1] }, c2 { c[2] }, c3 { c[3] };
+	uint32_t k0 { _key[0] }, k1 { _key[1] };
+	for ( size_t round = 0; round < 10; ++round ) {
+		const uint64_t p0 { uint64_t(0xD2511F53u) * c0 };
+		const uint64_t p1 { uint64_t(0xCD9E8D57u) * c2 };
+		c0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+		c1 = uint32_t(p1);
+		c2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+		c3 = uint32_t(p0);
+		k0 += 0x9E3779B9u;
+		k1 += 0xBB67AE85u;
+	}
+	return Counter{{ c0, c1, c2, c3 }};
+};
+
+} // namespace Euclid
+
+#endif
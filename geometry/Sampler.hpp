@@ -0,0 +1,243 @@
+#ifndef EUCLID_GEOMETRY_SAMPLER
+#define EUCLID_GEOMETRY_SAMPLER
+
+// Points sampled uniformly over the surface of a triangle mesh.
+// A sample takes one call of the counter-based generator in Random.hpp, four numbers:
+// two draw a triangle with probability proportional to its area from an alias table
+// (Walker's method, built as by Vose), in O(1) whatever the number of triangles, and two
+// give a uniform point in it, the barycentric coordinates of the unit square reflected
+// into the triangle. Sample i is a fixed function of the seed and i, so generate gives
+// the same points whatever the number of threads, and ranges of the stream made on
+// different machines join into one.
+// poisson_disk thins the same stream into blue noise: a sample is kept if no kept sample
+// lies within the radius, by straight line distance. Kept samples go into a spatial hash
+// with cells small enough to hold at most one each, so a test looks at one sample per
+// nearby cell. It runs on one thread and stops after a number of rejections in a row,
+// by which point the surface is nearly covered.
+// Storage comes from a std::pmr::memory_resource, as for Hierarchy.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Random.hpp"
+#include "Parallel.hpp"
+
+namespace Euclid {
+
+// Draws index i with probability weight(i) / sum of weights, in constant time
+class AliasTable {
+	public :
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+	AliasTable ( const double * weights, size_t N, allocator_type = {} );
+
+	size_t size ( ) const { return _entries.size(); }
+	// An index, from two uniformly distributed 32 bit numbers
+	size_t operator () ( uint32_t column, uint32_t coin ) const
+	{
+		const size_t i { column_index(column) };
+		return coin < _entries[i].threshold ? i : _entries[i].alias;
+	}
+	// Hint that the entry for column will be read soon
+	void prefetch ( uint32_t column ) const { Euclid::prefetch( &_entries[ column_index(column) ] ); }
+
+	private :
+	// Column i keeps i with probability threshold / 2^32, and gives alias otherwise
+	struct Entry {
+		uint32_t threshold;
+		uint32_t alias;
+	};
+	std::pmr::vector<Entry> _entries;
+
+	size_t column_index ( uint32_t column ) const { return size_t( ( uint64_t(column) * _entries.size() ) >> 32 ); }
+};
+
+inline
+AliasTable::AliasTable ( const double * weights, size_t N, allocator_type alloc ) : _entries(N,alloc)
+{
+	assert( N > 0 && N <= UINT32_MAX );
+	double sum { 0. };
+	for ( size_t i = 0; i < N; ++i ) { assert( weights[i] >= 0. ); sum += weights[i]; }
+	assert( sum > 0. );
+
+	// Scaled so the mean is one. Each column below one is filled up from one above, which
+	// loses the difference, until one side runs out: what is left is one up to rounding.
+	std::pmr::vector<double> p( N, alloc );
+	std::pmr::vector<uint32_t> small( alloc ), large( alloc );
+	small.reserve(N);
+	large.reserve(N);
+	for ( size_t i = 0; i < N; ++i ) {
+		p[i] = weights[i] * double(N) / sum;
+		( p[i] < 1. ? small : large ).push_back( uint32_t(i) );
+	}
+	while ( !small.empty() && !large.empty() ) {
+		const uint32_t s { small.back() };
+		const uint32_t l { large.back() };
+		small.pop_back();
+		_entries[s] = Entry { uint32_t( std::min( p[s] * 4294967296., 4294967295. ) ), l };
+		p[l] = ( p[l] + p[s] ) - 1.;
+		if ( p[l] < 1. ) { large.pop_back(); small.push_back(l); }
+	}
+	for ( uint32_t i : small ) _entries[i] = Entry { UINT32_MAX, i };
+	for ( uint32_t i : large ) _entries[i] = Entry { UINT32_MAX, i };
+};
+
+class Sampler {
+	public :
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+	Sampler ( const Triangle *, size_t, uint64_t seed = 0, allocator_type = {} );
+	Sampler ( const std::vector<Triangle> & T, uint64_t seed = 0, allocator_type alloc = {} ) : Sampler(T.data(),T.size(),seed,alloc) {};
+
+	// Data access
+	const Triangle & 	triangle	( size_t i ) const { return _triangles[i]; }
+	size_t 				size		( ) const { return _triangles.size(); }
+	double 				area		( ) const { return _area; }
+	allocator_type 		get_allocator ( ) const { return _triangles.get_allocator(); }
+
+	// Sample i of the stream, and the index of its triangle
+	Point 	sample 		( uint64_t i ) const { size_t t { 0 }; return sample(i,t); }
+	Point 	sample 		( uint64_t, size_t & ) const;
+
+	// Samples first to first+count-1 of the stream, and optionally their triangles
+	void 	generate 	( Point *, size_t count, uint64_t first = 0, size_t * triangles = nullptr, size_t threads = std::thread::hardware_concurrency() ) const;
+
+	// The samples of the stream that are farther than radius from every earlier one kept,
+	// until attempts samples in a row are rejected or max are kept. Optionally their triangles.
+	std::vector<Point> 	poisson_disk ( double radius, size_t attempts = 1000, size_t max = SIZE_MAX, std::vector<size_t> * triangles = nullptr ) const;
+
+	private :
+	std::pmr::vector<Triangle> 	_triangles;
+	AliasTable 					_alias;
+	Philox 						_random;
+	double 						_area { 0. };
+
+	// The point at barycentric coordinates from two 32 bit numbers
+	Point 	point 		( size_t triangle, uint32_t, uint32_t ) const;
+
+	static std::pmr::vector<double> areas ( const Triangle *, size_t, allocator_type );
+};
+
+inline std::pmr::vector<double>
+Sampler::areas ( const Triangle * T, size_t N, allocator_type alloc )
+{
+	std::pmr::vector<double> a( N, alloc );
+	for ( size_t i = 0; i < N; ++i ) a[i] = T[i].area();
+	return a;
+};
+
+inline
+Sampler::Sampler ( const Triangle * T, size_t N, uint64_t seed, allocator_type alloc )
+: _triangles(T,T+N,alloc), _alias(areas(T,N,alloc).data(),N,alloc), _random(seed)
+{
+	for ( const Triangle & t : _triangles ) _area += t.area();
+};
+
+inline Point
+Sampler::sample ( uint64_t i, size_t & triangle ) const
+{
+	const Philox::Counter r { _random(i) };
+	triangle = _alias( r[0], r[1] );
+	return point( triangle, r[2], r[3] );
+};
+
+inline Point
+Sampler::point ( size_t triangle, uint32_t u, uint32_t v ) const
+{
+	double a { Philox::uniform(u) }, b { Philox::uniform(v) };
+	if ( a + b > 1. ) { a = 1. - a; b = 1. - b; }
+	const Triangle & t = _triangles[triangle];
+	const Point p { t.vertex(0) };
+	return Point( p + Vector(p,t.vertex(1))*a + Vector(p,t.vertex(2))*b );
+};
+
+inline void
+Sampler::generate ( Point * P, size_t count, uint64_t first, size_t * triangles, size_t threads ) const
+{
+	parallel_for( count, threads, 4096, [&]( size_t begin, size_t end ) {
+		// In blocks: the generator runs over a whole block in a loop the compiler can
+		// vectorise, and the table entries and triangles of a block are prefetched before
+		// they are read, so that their cache misses overlap
+		constexpr size_t block { 64 };
+		std::array<Philox::Counter,block> r;
+		std::array<size_t,block> t;
+		for ( size_t b = begin; b < end; b += block ) {
+			const size_t n { std::min( block, end-b ) };
+			for ( size_t k = 0; k < n; ++k ) r[k] = _random( first+b+k );
+			for ( size_t k = 0; k < n; ++k ) _alias.prefetch( r[k][0] );
+			for ( size_t k = 0; k < n; ++k ) { t[k] = _alias( r[k][0], r[k][1] ); prefetch( &_triangles[t[k]] ); }
+			for ( size_t k = 0; k < n; ++k ) {
+				P[b+k] = point( t[k], r[k][2], r[k][3] );
+				if ( triangles ) triangles[b+k] = t[k];
+			}
+		}
+	} );
+};
+
+inline std::vector<Point>
+Sampler::poisson_disk ( double radius, size_t attempts, size_t max, std::vector<size_t> * triangles ) const
+{
+	assert( radius > 0. );
+	std::vector<Point> kept;
+	if ( triangles ) triangles->clear();
+
+	// Open addressing on integer cell coordinates. The cell diagonal is the radius, so a
+	// cell holds at most one kept sample and those within reach are at most two cells away.
+	struct Slot {
+		int64_t 	x, y, z;
+		uint32_t 	sample { UINT32_MAX }; // Empty if UINT32_MAX
+	};
+	const double cell { radius / std::sqrt(3.) };
+	std::pmr::vector<Slot> table( 1024, get_allocator() );
+	size_t mask { table.size()-1 }, used { 0 };
+	auto hash = []( int64_t x, int64_t y, int64_t z ) { return size_t( ( uint64_t(x)*0x9E3779B97F4A7C15ull ^ uint64_t(y)*0xC2B2AE3D27D4EB4Full ^ uint64_t(z)*0x165667B19E3779F9ull ) >> 17 ); };
+	auto find = [&]( int64_t x, int64_t y, int64_t z ) -> Slot & {
+		size_t h { hash(x,y,z) & mask };
+		while ( table[h].sample != UINT32_MAX && ( table[h].x != x || table[h].y != y || table[h].z != z ) ) h = (h+1) & mask;
+		return table[h];
+	};
+	auto insert = [&]( int64_t x, int64_t y, int64_t z, uint32_t s ) {
+		// Keep the table at most half full
+		if ( 2*(used+1) > table.size() ) {
+			const std::pmr::vector<Slot> old( std::move(table) );
+			table = std::pmr::vector<Slot>( 2*old.size(), get_allocator() );
+			mask = table.size()-1;
+			for ( const Slot & o : old ) if ( o.sample != UINT32_MAX ) find( o.x, o.y, o.z ) = o;
+		}
+		find( x, y, z ) = Slot { x, y, z, s };
+		++used;
+	};
+
+	size_t rejected { 0 }, t { 0 };
+	for ( uint64_t i = 0; rejected < attempts && kept.size() < max && kept.size() < UINT32_MAX; ++i ) {
+		const Point p { sample(i,t) };
+		const int64_t cx { int64_t(std::floor(p.x()/cell)) }, cy { int64_t(std::floor(p.y()/cell)) }, cz { int64_t(std::floor(p.z()/cell)) };
+		bool free { true };
+		for ( int64_t z = cz-2; z <= cz+2 && free; ++z )
+		for ( int64_t y = cy-2; y <= cy+2 && free; ++y )
+		for ( int64_t x = cx-2; x <= cx+2 && free; ++x ) {
+			const Slot & s = find(x,y,z);
+			if ( s.sample != UINT32_MAX && Vector(p,kept[s.sample]).norm() < radius*radius ) free = false;
+		}
+		if ( !free ) { ++rejected; continue; }
+		rejected = 0;
+		insert( cx, cy, cz, uint32_t(kept.size()) );
+		kept.push_back(p);
+		if ( triangles ) triangles->push_back(t);
+	}
+	return kept;
+};
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef EUCLID_GEOMETRY_STATICHIERARCHY
+#define EUCLID_GEOMETRY_STATICHIERARCHY
+
+// Bounding box hierarchy over a fixed set of N triangles.
+// Everything, including the build, is constexpr, such that a hierarchy declared
+//     constexpr StaticHierarchy<N> H { triangles };
+// is computed by the compiler and placed in static storage: no heap, no startup cost.
+// Triangles are split by Box::box_and_split, with one triangle per leaf, so there are
+// exactly 2N-1 nodes. See Traversal.hpp for the node layout.
+// Compile time evaluation is bounded by the compiler: within the default limit of GCC the
+// build handles some 1500 triangles. Larger sets need the limit raised (-fconstexpr-ops-limit
+// for GCC, -fconstexpr-steps for Clang), or a Hierarchy built at run time.
+
+#include <array>
+#include <cfloat>
+#include <cstddef>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Ray.hpp"
+#include "Box.hpp"
+#include "Traversal.hpp"
+
+namespace Euclid {
+
+template<size_t N>
+class StaticHierarchy {
+	static_assert( N > 0 , "StaticHierarchy needs at least one triangle" );
+	public :
+	using Node = HierarchyNode;
+	using Stack = std::array<size_t,N>; // A tree over N triangles is at most N-1 deep
+	constexpr static size_t node_count { 2*N-1 };
+
+	constexpr StaticHierarchy ( const std::array<Triangle,N> & );
+
+	// Data access
+	constexpr const Node & 		node		( size_t i ) const { return _nodes[i]; }
+	constexpr const Triangle & 	triangle	( size_t i ) const { return _triangles[i]; }
+	constexpr const Box & 		box			( ) const { return _nodes[0].box; }
+	constexpr static size_t 	size		( ) { return N; }
+
+	// Queries
+	constexpr size_t 	closest_triangle	( const Point & ) const;
+	constexpr Point 	closest_point		( const Point & ) const;
+	constexpr bool 		distance			( const Point & , double&, double&) const;
+	constexpr bool 		intersect			( const Ray &, double & ) const;
+	constexpr bool 		intersect			( const Point &, const Vector &, double & ) const;
+
+	private :
+	std::array<Triangle,N> 			_triangles;
+	std::array<Node,node_count> 	_nodes;
+};
+
+template<size_t N>
+constexpr
+StaticHierarchy<N>::StaticHierarchy ( const std::array<Triangle,N> & triangles ) : _triangles(triangles), _nodes()
+{
+	// Bounds of the triangles once, rather than at every level of the build
+	std::array<size_t,N> index {};
+	std::array<Box,N> boxes {};
+	std::array<Point,N> centers {};
+	for ( size_t i = 0; i < N; ++i ) {
+		index[i] = i;
+		boxes[i] = Box::box( _triangles[i] );
+		centers[i] = _triangles[i].center();
+	}
+	size_t next { 0 };
+	// A tree over N triangles is at most N-1 deep, so no depth limit is needed
+	build_hierarchy( boxes.data(), centers.data(), _nodes, index.data(), index.data()+N, next, N );
+};
+
+template<size_t N>
+constexpr size_t
+StaticHierarchy<N>::closest_triangle ( const Point & p ) const
+{
+	Stack stack {};
+	return Euclid::closest_triangle( _triangles, _nodes, p, stack );
+};
+
+template<size_t N>
+constexpr Point
+StaticHierarchy<N>::closest_point ( const Point & p ) const
+{
+	return _triangles[closest_triangle(p)].closest_point(p);
+};
+
+template<size_t N>
+constexpr bool
+StaticHierarchy<N>::distance ( const Point & p , double&sq_dist, double&sign) const
+{
+	return _triangles[closest_triangle(p)].distance(p,sq_dist,sign);
+};
+
+template<size_t N>
+constexpr bool
+StaticHierarchy<N>::intersect ( const Ray & r, double & t ) const
+{
+	return intersect(r.origin(),r.direction(),t);
+};
+
+template<size_t N>
+constexpr bool
+StaticHierarchy<N>::intersect ( const Point & src, const Vector & dir, double & t ) const
+{
+	Stack stack {};
+	return Euclid::intersect( _triangles, _nodes, src, dir, t, stack );
+};
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef EUCLID_GEOMETRY_TIGHTHIERARCHY
+#define EUCLID_GEOMETRY_TIGHTHIERARCHY
+
+// Tighter node bounds on top of a Hierarchy, for geometry such as long diagonal pipes and
+// beams where the node boxes are loose and closest point queries open most of the tree.
+// Every node is fitted with a Bound (OrientedBox or DOP<K>), which is kept only where it
+// pays off by the surface area heuristic: the chance that a query has to open a node is
+// taken as proportional to the surface area of its bound, so a tight bound is kept if its
+// area is below 'ratio' times the area of the node box, ratio < 1 accounting for the cost
+// of the extra test. Nodes with a tight bound are culled by both.
+// The Hierarchy is referenced, not copied, and must outlive this object.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Ray.hpp"
+#include "Box.hpp"
+#include "Traversal.hpp"
+#include "Hierarchy.hpp"
+
+namespace Euclid {
+
+template<class Bound>
+class TightHierarchy {
+	public :
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+	using Node = HierarchyNode;
+	using Stack = Hierarchy::Stack;
+
+	TightHierarchy ( const Hierarchy &, double ratio = 0.8, allocator_type = {} );
+
+	// Data access
+	const Node & 		node		( size_t i ) const { return _h.node(i); }
+	const Triangle & 	triangle	( size_t i ) const { return _h.triangle(i); }
+	const Box & 		box			( ) const { return _h.box(); }
+	size_t 				size		( ) const { return _h.size(); }
+	const Bound * 		bound		( size_t i ) const { return _index[i] == none ? nullptr : &_bounds[_index[i]]; }
+	size_t 				tightened	( ) const { return _bounds.size(); } // Nodes with a tight bound
+
+	// Queries
+	size_t 	closest_triangle	( const Point & ) const;
+	Point 	closest_point		( const Point & ) const;
+	bool 	distance			( const Point & , double&, double&) const;
+	bool 	intersect			( const Ray &, double & ) const;
+	bool 	intersect			( const Point &, const Vector &, double & ) const;
+
+	private :
+	constexpr static uint32_t none { UINT32_MAX };
+	const Hierarchy & 			_h;
+	std::pmr::vector<uint32_t> 	_index; // Per node, index into _bounds or none
+	std::pmr::vector<Bound> 	_bounds;
+
+	// Views of the Hierarchy for the shared traversal
+	struct Triangles { const Hierarchy & h; const Triangle & operator[] ( size_t i ) const { return h.triangle(i); } };
+	struct Nodes { const Hierarchy & h; const Node & operator[] ( size_t i ) const { return h.node(i); } };
+
+	// Node box and tight bound combined, see BoxBounds
+	struct Bounds {
+		const TightHierarchy & t;
+		double min_sq_dist ( const HierarchyNode & node, size_t n, const Point & p, double limit ) const
+		{
+			const double min_sq { BoxBounds().min_sq_dist( node, n, p, limit ) };
+			if ( min_sq > limit || t._index[n] == none ) return min_sq;
+			return std::max( min_sq, t._bounds[t._index[n]].min_sq_dist( p, limit ) );
+		}
+		bool intersect ( const HierarchyNode & node, size_t n, const Point & src, const Vector & dir ) const
+		{
+			return node.box.intersect(src,dir) && ( t._index[n] == none || t._bounds[t._index[n]].intersect(src,dir) );
+		}
+	};
+};
+
+template<class Bound>
+TightHierarchy<Bound>::TightHierarchy ( const Hierarchy & h, double ratio, allocator_type alloc ) : _h(h), _index(alloc), _bounds(alloc)
+{
+	const size_t count { 2*h.size()-1 };
+	_index.assign( count, none );
+	std::pmr::vector<Point> points( alloc );
+	points.reserve( 3*h.size() );
+	for ( size_t n = 0; n < count; ++n ) {
+		// Nodes are depth first, so the subtree of n ends after its rightmost leaf
+		size_t end { n };
+		while ( !h.node(end).leaf() ) end = h.node(end).right;
+		points.clear();
+		for ( size_t k = n; k <= end; ++k ) {
+			if ( !h.node(k).leaf() ) continue;
+			for ( const Point & v : h.triangle(h.node(k).triangle).vertices() ) points.push_back(v);
+		}
+		Bound b { Bound::fit( points.data(), points.size() ) };
+		if ( b.surface_area() < ratio * h.node(n).box.surface_area() ) {
+			_index[n] = uint32_t(_bounds.size());
+			_bounds.push_back(b);
+		}
+	}
+};
+
+template<class Bound>
+size_t
+TightHierarchy<Bound>::closest_triangle ( const Point & p ) const
+{
+	Stack stack;
+	return Euclid::closest_triangle( Triangles{_h}, Nodes{_h}, p, stack, Bounds{*this} );
+};
+
+template<class Bound>
+Point
+TightHierarchy<Bound>::closest_point ( const Point & p ) const
+{
+	return triangle(closest_triangle(p)).closest_point(p);
+};
+
+template<class Bound>
+bool
+TightHierarchy<Bound>::distance ( const Point & p , double&sq_dist, double&sign) const
+{
+	return triangle(closest_triangle(p)).distance(p,sq_dist,sign);
+};
+
+template<class Bound>
+bool
+TightHierarchy<Bound>::intersect ( const Ray & r, double & t ) const
+{
+	return intersect(r.origin(),r.direction(),t);
+};
+
+template<class Bound>
+bool
+TightHierarchy<Bound>::intersect ( const Point & src, const Vector & dir, double & t ) const
+{
+	Stack stack;
+	return Euclid::intersect( Triangles{_h}, Nodes{_h}, src, dir, t, stack, Bounds{*this} );
+};
+
+} // namespace Euclid
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef EUCLID_GEOMETRY_TRAVERSAL
+#define EUCLID_GEOMETRY_TRAVERSAL
+
+// Node layout, build and queries shared by the bounding box hierarchies.
+// Nodes are stored depth first with one triangle per leaf: the left child of
+// node i is node i+1, the right child is stored in the node.
+// The functions work on any random access containers of nodes and triangles,
+// and take their traversal stack from the caller, so they never allocate.
+
+#include <cfloat>
+#include <cstddef>
+
+#include "Point.hpp"
+#include "Vector.hpp"
+#include "Triangle.hpp"
+#include "Box.hpp"
+
+namespace Euclid {
+
+struct HierarchyNode {
+	Box 	box;
+	size_t 	right 		{ 0 }; // Index of right child, 0 for a leaf
+	size_t 	triangle 	{ 0 }; // Index of triangle, leaf only
+	constexpr bool leaf() const { return right == 0; }
+};
+
+// Node bounds used by the queries: the node boxes. Hierarchies with other bounding
+// volumes pass their own type with the same two functions. min_sq_dist may stop early
+// and return any value above limit once the node is known to be farther than that.
+struct BoxBounds {
+	constexpr double 	min_sq_dist ( const HierarchyNode & node, size_t, const Point & p, double ) const
+	{
+		double min_sq { 0. }, max_sq { 0. };
+		node.box.minmax_sq_dist( p, min_sq, max_sq );
+		return min_sq;
+	}
+	constexpr bool 		intersect 	( const HierarchyNode & node, size_t, const Point & src, const Vector & dir ) const { return node.box.intersect(src,dir); }
+};
+
+// Smallest d such that 2^d >= n
+constexpr size_t ceil_log2 ( size_t n ) { size_t d { 0 }; while ( (size_t(1) << d) < n ) ++d; return d; }
+
+// Build the subtree over the index range [first,last), partitioning it in place.
+// boxes and centers hold the bounding box and center of every triangle.
+// Node storage must already hold 2*(last-first)-1 nodes from index next onwards.
+// Splits follow Box::box_and_split until the subtree could grow deeper than max_depth,
+// after which ranges are halved, so the tree is never deeper than max_depth.
+template<class Nodes>
+constexpr size_t
+build_hierarchy ( const Box * boxes, const Point * centers, Nodes & nodes, size_t * first, size_t * last, size_t & next, size_t max_depth, size_t depth = 0 )
+{
+	const size_t n { next++ };
+	if ( last - first == 1 ) {
+		nodes[n].box = boxes[*first];
+		nodes[n].triangle = *first;
+		return n;
+	}
+	size_t * mid { nullptr };
+	nodes[n].box = Box::box_and_split( boxes, centers, first, last, mid );
+	if ( depth + ceil_log2( size_t(last-first) ) >= max_depth ) mid = first + (last-first)/2;
+	build_hierarchy( boxes, centers, nodes, first, mid, next, max_depth, depth+1 );
+	nodes[n].right = build_hierarchy( boxes, centers, nodes, mid, last, next, max_depth, depth+1 );
+	return n;
+}
+
+// Branch and bound visiting the nearest child first, seeded with an upper bound best_sq on
+// the squared distance. Returns whether a triangle closer than that was found, in which case
+// best and best_sq hold it. The stack needs room for one more entry than the depth of the tree.
+template<class Triangles, class Nodes, class Stack, class Bounds = BoxBounds>
+constexpr bool
+closest_triangle_within ( const Triangles & triangles, const Nodes & nodes, const Point & p, Stack & stack, double & best_sq, size_t & best, const Bounds & bounds = Bounds() )
+{
+	size_t top { 0 };
+	stack[top++] = 0;
+	bool found { false };
+	while ( top > 0 ) {
+		const size_t n { stack[--top] };
+		const HierarchyNode & node = nodes[n];
+		if ( bounds.min_sq_dist( node, n, p, best_sq ) > best_sq ) continue;
+		if ( node.leaf() ) {
+			double sq_dist { Vector( p , triangles[node.triangle].closest_point(p) ).norm() };
+			if ( sq_dist < best_sq ) { best_sq = sq_dist; best = node.triangle; found = true; }
+			continue;
+		}
+		const size_t l { n + 1 };
+		const size_t r { node.right };
+		const double lmin { bounds.min_sq_dist( nodes[l], l, p, best_sq ) };
+		const double rmin { bounds.min_sq_dist( nodes[r], r, p, best_sq ) };
+		// Push the farthest child first so the nearest is visited first
+		if ( lmin < rmin ) { stack[top++] = r; stack[top++] = l; }
+		else 			   { stack[top++] = l; stack[top++] = r; }
+	}
+	return found;
+}
+
+// Index of the triangle closest to p
+template<class Triangles, class Nodes, class Stack, class Bounds = BoxBounds>
+constexpr size_t
+closest_triangle ( const Triangles & triangles, const Nodes & nodes, const Point & p, Stack & stack, const Bounds & bounds = Bounds() )
+{
+	double best_sq { DBL_MAX };
+	size_t best { 0 };
+	closest_triangle_within( triangles, nodes, p, stack, best_sq, best, bounds );
+	return best;
+}
+
+// Nearest intersection in front of the source, t is only assigned on a hit
+template<class Triangles, class Nodes, class Stack, class Bounds = BoxBounds>
+constexpr bool
+intersect ( const Triangles & triangles, const Nodes & nodes, const Point & src, const Vector & dir, double & t, Stack & stack, const Bounds & bounds = Bounds() )
+{
+	size_t top { 0 };
+	stack[top++] = 0;
+	bool hit { false };
+	while ( top > 0 ) {
+		const size_t n { stack[--top] };
+		const HierarchyNode & node = nodes[n];
+		if ( !bounds.intersect( node, n, src, dir ) ) continue;
+		if ( node.leaf() ) {
+			double s { 0. };
+			if ( triangles[node.triangle].intersect(src,dir,s) && s >= 0 && ( !hit || s < t ) ) { t = s; hit = true; }
+			continue;
+		}
+		stack[top++] = node.right;
+		stack[top++] = n + 1;
+	}
+	return hit;
+}
+
+} // namespace Euclid
+
+#endif
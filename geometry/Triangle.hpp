@@ -100,7 +100,7 @@ namespace Euclid {
 		// which is not considered an intersect
 		double eps 	{ 1e-10 };
 		Vector tvec { vertex(0),src };
-		Vector pvec = cross( dir, edge(2).as_vector() );
+		Vector pvec = cross( dir, -edge(2).as_vector() );
 		double det { dot( edge(0).as_vector() , pvec ) };
 		if ( abs(det) < eps ) return false;
 		double inv { 1.0 / det };
@@ -164,10 +164,11 @@ namespace Euclid {
 			double a = dot(t,s) / l; // Coordinate along edge
 			if ( a <= 0 ) { scores[i]++; if ( scores[i] == 2 ) return vertex(i); } 
 			if ( a >= 1 ) { scores[j]++; if ( scores[j] == 2 ) return vertex(j); }
-			if ( a < 1 && a > 0 && dot(t,cross(s,normal())) >= 0 ) return { Point( vertex(i) + s ) * ( a * l ) };
+			if ( a < 1 && a > 0 && dot(t,cross(s,normal())) >= 0 ) return { vertex(i) + s * ( a * l ) };
 		}
 		// If we get here, we are directly above or below
-		return { Point( p - normal() ) * dot(Vector(vertex(0),p),normal()) };
+		const Vector n { normal() };
+		return { p - n * dot(Vector(vertex(0),p),n) };
 	};
 
 }
@@ -21,18 +21,24 @@ class Vector : public Cartesian {
 	constexpr Vector( const double & x, const double & y, const double & z ) : Cartesian(x,y,z) {};
 	constexpr Vector( const Point & P ) : Cartesian(P.x(),P.y(),P.z()) {};
 	constexpr Vector( const Point & p1 , const Point & p2 ) : Cartesian(p2.x()-p1.x(),p2.y()-p1.y(),p2.z()-p1.z()) {};
+	template<class E, typename = std::enable_if_t<is_expression_v<E>>>
+	constexpr Vector( const E & e ) : Cartesian(e) {};
 	
 	// Properties
 	constexpr double norm	( ) const { return data[0]*data[0] + data[1]*data[1] + data[2]*data[2]; };
 	constexpr double length	( ) const { return sqrt( norm() ); };
 	
-	// Binary arithmetic explicitly synthesised from Cartesian
-	constexpr Vector operator * ( const double & a ) const { Cartesian::operator * ( a ); return *this; };
-	constexpr Vector operator / ( const double & a ) const { Cartesian::operator / ( a ); return *this; }; 
+	// Binary arithmetic is lazy, see Expression.hpp
+	// Short arithmetic explicitly synthesised from Cartesian
 	const Vector operator += ( const double & a ) { Cartesian::operator += ( a ); return *this; };
 	const Vector operator -= ( const double & a ) { Cartesian::operator -= ( a ); return *this; }; 
 	const Vector operator *= ( const double & a ) { Cartesian::operator *= ( a ); return *this; };
 	const Vector operator /= ( const double & a ) { Cartesian::operator /= ( a ); return *this; }; 
+	// Elementwise compound assignment from a Cartesian type or expression
+	using Cartesian::operator +=;
+	using Cartesian::operator -=;
+	using Cartesian::operator *=;
+	using Cartesian::operator /=;
 	
 	// Linear algebra operators
 	constexpr Vector cross 	( const Vector & ) 	const;
@@ -51,7 +57,7 @@ class Vector : public Cartesian {
 	constexpr Vector operator >= ( const double & );
 	
 	friend std::ostream & operator << ( std::ostream & out, const Vector A ) { return out << A.x() << "," << A.y() << "," << A.z() << ";"; };
-	friend std::ostream & operator << ( std::ostream & out, const std::vector<Vector> v ) { for ( Vector c : v ) out << "\n\t" << c; out << std::endl; return out; };
+	friend std::ostream & operator << ( std::ostream & out, const std::vector<Vector> & v ) { for ( const Vector & c : v ) out << "\n\t" << c; out << std::endl; return out; };
 	
 };
 
@@ -93,25 +99,6 @@ inline constexpr double Vector::angle ( const Vector & b )  const
 constexpr Vector cross ( const Vector & v1 , const Vector & v2 ) { return v1.cross(v2); };
 constexpr double dot   ( const Vector & v1 , const Vector & v2 ) { return v1.dot(v2); };
 
-// Vector point friendships
-inline constexpr Point operator + ( const Point & p , const Vector & v ) { return Point { p + Point( v.x(),v.y(),v.z() ) }; };
-inline constexpr Point operator - ( const Point & p , const Vector & v ) { return Point { p - Point( v.x(),v.y(),v.z() ) }; };
-inline constexpr Point operator * ( const Point & p , const Vector & v ) { return Point { p.x()*v.x() , p.y()*v.y() , p.z()*v.z() }; };
-inline constexpr Point operator / ( const Point & p , const Vector & v ) { return Point { p.x()/v.x() , p.y()/v.y() , p.z()/v.z() }; };
-
-// Returns the elementwise smallest value
-inline constexpr Vector emin ( const Vector & v1 , const Vector & v2 ) 
-{
-	using std::min;
-	return Vector {min(v1.x(),v2.x()),min(v1.y(),v2.y()),min(v1.z(),v2.z())};
-}
-// Returns the elementwise largest value
-inline constexpr Vector emax ( const Vector & v1 , const Vector & v2 ) 
-{
-	using std::max;
-	return Vector {max(v1.x(),v2.x()),max(v1.y(),v2.y()),max(v1.z(),v2.z())};
-}
-
 } // namespace Euclid
 
 #endif